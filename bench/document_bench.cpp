@@ -0,0 +1,266 @@
+// File: bench/document_bench.cpp
+// Author: Kyle Lukaszek
+// Email: kylelukaszek [at] gmail [dot] com
+// Date: 2024-09-21
+// -------------------------------------------------------------
+//
+// License: Apache 2.0 (Follows the same license as Tint)
+//
+// Description: Times the diagnostics of a WGSL document after an
+//              edit, checked incrementally with tint_document_edit()
+//              and tint_document_check() against checking the whole
+//              new text, the way a language server that rebuilds
+//              the file on every change would.
+//
+//              -------------------------------------------------
+//
+//        ->    make document-bench
+//        ->    node build/document_bench.js [shader dir] [iterations]
+//
+//              -------------------------------------------------
+//
+//              Runs on a generated shader of about 5000 lines, plus
+//              every WGSL file in the directory. Each iteration
+//              edits a return statement three ways: it types a space,
+//              an unclosed parenthesis (a syntax error) and a prefix
+//              that makes an identifier unresolved, deleting each one
+//              again before the next. Then it makes two identifiers
+//              unresolved in unrelated functions and fixes them again
+//              in the same order. After every edit, and after checking
+//              again without one, the incremental diagnostics have to
+//              match the ones of a full check, otherwise the benchmark
+//              fails.
+//
+// ---------------------------------------------------------------
+
+#include "bench/shaders.h"
+#include "spirv-tools/libspirv.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <tuple>
+
+using Diagnostics =
+    std::vector<std::tuple<uint8_t, uint32_t, uint32_t, std::string>>;
+
+// Returns: A shader of `groups` times 37 lines, each group a struct, a
+//          storage buffer, two helper functions and a compute entry point
+static std::string GenerateShader(int groups) {
+  std::string wgsl;
+  for (int i = 0; i < groups; i++) {
+    std::string k = std::to_string(i);
+    wgsl += "struct Particle" + k + " {\n"
+            "  position : vec4f,\n"
+            "  velocity : vec4f,\n"
+            "}\n"
+            "\n"
+            "@group(" + std::to_string(i / 8) + ") @binding(" +
+            std::to_string(i % 8) + ")\n"
+            "var<storage, read_write> particles" + k + " : array<Particle" +
+            k + ">;\n"
+            "\n"
+            "fn integrate" + k + "(p : Particle" + k + ", dt : f32) -> "
+            "Particle" + k + " {\n"
+            "  var out = p;\n"
+            "  let accel = vec4f(0.0, -9.8, 0.0, 0.0);\n"
+            "  out.velocity = out.velocity + accel * dt;\n"
+            "  out.position = out.position + out.velocity * dt;\n"
+            "  return out;\n"
+            "}\n"
+            "\n"
+            "fn damp" + k + "(v : vec4f) -> vec4f {\n"
+            "  let speed = length(v.xyz);\n"
+            "  if (speed > 10.0) {\n"
+            "    return v * (10.0 / speed);\n"
+            "  }\n"
+            "  return v;\n"
+            "}\n"
+            "\n"
+            "@compute @workgroup_size(64)\n"
+            "fn main" + k + "(@builtin(global_invocation_id) id : vec3u) {\n"
+            "  let i = id.x;\n"
+            "  if (i >= arrayLength(&particles" + k + ")) {\n"
+            "    return;\n"
+            "  }\n"
+            "  var p = integrate" + k + "(particles" + k + "[i], 0.016);\n"
+            "  p.velocity = damp" + k + "(p.velocity);\n"
+            "  particles" + k + "[i] = p;\n"
+            "}\n"
+            "\n";
+  }
+  return wgsl;
+}
+
+// Returns: The diagnostics of the last check of `doc`
+static Diagnostics Read(TintDocument *doc) {
+  uint32_t count = 0;
+  const TintDiagnostic *rows = tint_document_diagnostics(doc, &count);
+  Diagnostics diagnostics;
+  for (uint32_t i = 0; i < count; i++) {
+    diagnostics.emplace_back(rows[i].severity, rows[i].line, rows[i].column,
+                             rows[i].message);
+  }
+  return diagnostics;
+}
+
+// Returns: The diagnostics of a document created from `text` and checked
+//          once, with the time that took in `us`
+static Diagnostics FullCheck(TintContext *ctx, const std::string &text,
+                             double &us) {
+  auto start = std::chrono::steady_clock::now();
+  TintDocument *doc = nullptr;
+  tint_context_document_create(ctx, text.data(), text.size(), &doc);
+  tint_document_check(doc);
+  auto end = std::chrono::steady_clock::now();
+  us = std::chrono::duration<double, std::micro>(end - start).count();
+  Diagnostics diagnostics = Read(doc);
+  tint_document_destroy(doc);
+  return diagnostics;
+}
+
+struct Edit {
+  uint32_t begin;
+  uint32_t end;
+  std::string text;
+};
+
+struct Timings {
+  std::vector<double> full_us;
+  std::vector<double> incremental_us;
+  uint64_t checked = 0;
+  uint64_t declarations = 0;
+  bool mismatch = false;
+};
+
+// Applies `edit` to `doc` and its copy of the text in `text`, then checks
+// it both ways
+static void Apply(TintContext *ctx, TintDocument *doc, std::string &text,
+                  const Edit &edit, Timings &timings) {
+  text.replace(edit.begin, edit.end - edit.begin, edit.text);
+
+  auto start = std::chrono::steady_clock::now();
+  tint_document_edit(doc, edit.begin, edit.end, edit.text.data(),
+                     edit.text.size());
+  tint_document_check(doc);
+  Diagnostics incremental = Read(doc);
+  auto end = std::chrono::steady_clock::now();
+  timings.incremental_us.push_back(
+      std::chrono::duration<double, std::micro>(end - start).count());
+
+  TintDocumentStats stats;
+  tint_document_stats(doc, &stats);
+  timings.checked += stats.checked_declarations;
+  timings.declarations += stats.declarations;
+
+  double full_us = 0.0;
+  Diagnostics full = FullCheck(ctx, text, full_us);
+  timings.full_us.push_back(full_us);
+  // Checking again without an edit must not change anything
+  tint_document_check(doc);
+  if (full != incremental || Read(doc) != incremental) {
+    timings.mismatch = true;
+  }
+}
+
+// Returns: The median of `samples`
+static double Median(std::vector<double> samples) {
+  std::nth_element(samples.begin(), samples.begin() + samples.size() / 2,
+                   samples.end());
+  return samples[samples.size() / 2];
+}
+
+// Returns: The largest of `samples`
+static double Max(const std::vector<double> &samples) {
+  return *std::max_element(samples.begin(), samples.end());
+}
+
+// Runs the edits of the benchmark on `text` and prints a row of results.
+// Returns: false if the diagnostics of an edit differ
+static bool Run(TintContext *ctx, const std::string &name, std::string text,
+                int iterations) {
+  // Edit the expression after a `return `, spread over the whole text
+  std::vector<uint32_t> sites;
+  for (size_t at = text.find("return "); at != std::string::npos;
+       at = text.find("return ", at + 1)) {
+    sites.push_back(static_cast<uint32_t>(at + 7));
+  }
+  if (sites.empty()) {
+    return true;
+  }
+
+  TintDocument *doc = nullptr;
+  tint_context_document_create(ctx, text.data(), text.size(), &doc);
+  if (tint_document_check(doc) != static_cast<uint32_t>(Status::kSuccess)) {
+    // Only shaders that are valid to begin with
+    tint_document_destroy(doc);
+    return true;
+  }
+
+  Timings timings;
+  for (int i = 0; i < iterations; i++) {
+    uint32_t site = sites[(i * 7919u) % sites.size()];
+    // Type a space and delete it again
+    Apply(ctx, doc, text, Edit{site, site, " "}, timings);
+    Apply(ctx, doc, text, Edit{site, site + 1, ""}, timings);
+    // Open a parenthesis that is never closed, then delete it
+    Apply(ctx, doc, text, Edit{site, site, "("}, timings);
+    Apply(ctx, doc, text, Edit{site, site + 1, ""}, timings);
+    // Refer to an identifier that doesn't exist, then fix it
+    Apply(ctx, doc, text, Edit{site, site, "zz_"}, timings);
+    Apply(ctx, doc, text, Edit{site, site + 3, ""}, timings);
+
+    // Two independent errors: break a later and then an earlier function,
+    // and fix the earlier one first, so that the error that is reported
+    // moves from one to the other
+    uint32_t other = sites[(i * 7919u + sites.size() / 2) % sites.size()];
+    if (other != site) {
+      uint32_t first = std::min(site, other);
+      uint32_t second = std::max(site, other);
+      Apply(ctx, doc, text, Edit{second, second, "zz_"}, timings);
+      Apply(ctx, doc, text, Edit{first, first, "zz_"}, timings);
+      Apply(ctx, doc, text, Edit{first, first + 3, ""}, timings);
+      Apply(ctx, doc, text, Edit{second, second + 3, ""}, timings);
+    }
+  }
+
+  size_t lines = std::count(text.begin(), text.end(), '\n') + 1;
+  TintDocumentStats stats;
+  tint_document_stats(doc, &stats);
+  printf("%-32s %7zu %7u %10.1f %12.1f %12.1f %9.1f\n", name.c_str(), lines,
+         stats.declarations, Median(timings.full_us) / 1000.0,
+         Median(timings.incremental_us) / 1000.0,
+         Max(timings.incremental_us) / 1000.0,
+         static_cast<double>(timings.checked) * 100.0 /
+             static_cast<double>(timings.declarations));
+  tint_document_destroy(doc);
+  if (timings.mismatch) {
+    fprintf(stderr, "%s: incremental diagnostics differ from a full check\n",
+            name.c_str());
+  }
+  return !timings.mismatch;
+}
+
+int main(int argc, char **argv) {
+  int iterations = argc > 2 ? std::max(1, atoi(argv[2])) : 20;
+
+  TintContextOptions options = {SPV_ENV_UNIVERSAL_1_3, 0, 0, 0, 0};
+  TintContext *ctx = tint_context_create(&options);
+
+  printf("%-32s %7s %7s %10s %12s %12s %9s\n", "shader", "lines", "decls",
+         "full (ms)", "incr (ms)", "incr max", "checked");
+
+  bool ok = Run(ctx, "generated", GenerateShader(135), iterations);
+  if (argc > 1) {
+    for (const Shader &shader : LoadShaders(argv[1])) {
+      if (shader.format == Format::kWgsl) {
+        ok &= Run(ctx, shader.name,
+                  std::string(shader.bytes.begin(), shader.bytes.end()),
+                  iterations);
+      }
+    }
+  }
+
+  tint_context_destroy(ctx);
+  return ok ? 0 : 2;
+}
@@ -0,0 +1,316 @@
+// File: bench/lexer_bench.cpp
+// Author: Kyle Lukaszek
+// Email: kylelukaszek [at] gmail [dot] com
+// Date: 2024-09-21
+// -------------------------------------------------------------
+//
+// License: Apache 2.0 (Follows the same license as Tint)
+//
+// Description: Compares the batch lexer (Lexer::Lex(), which
+//              builds the whole token vector) against the
+//              streaming TokenStream and the compact TokenTable on
+//              every WGSL file in a directory, by time and by peak
+//              heap use, and the
+//              perfect hash lookups of keywords and builtin names
+//              against the comparisons they replace.
+//
+//              -------------------------------------------------
+//
+//        ->    make lexer-bench
+//        ->    node build/lexer_bench.js <shader dir> [iterations]
+//
+//              -------------------------------------------------
+//
+//              Both lexers are driven to the end of the file the
+//              way the parser consumes tokens. Peak heap is the
+//              most memory the lexer held at once on top of what
+//              was allocated before it started, counted by the
+//              global operator new of this benchmark. The token
+//              sequences of all lexers, and the sources TokenTable
+//              works out from its offsets, have to match, otherwise
+//              the benchmark fails.
+//
+//              The lookups are timed over every identifier-like
+//              word of the shaders. Keywords are compared with a
+//              scan of the keyword list, the way the lexer does it,
+//              and builtin names with the parse functions of
+//              libtint. Both sides have to agree on every word.
+//
+// ---------------------------------------------------------------
+
+#include "bench/shaders.h"
+#include "lang/core/builtin_lookup.h"
+#include "lang/wgsl/builtin_lookup.h"
+#include "lang/wgsl/reader/parser/keywords.h"
+#include "lang/wgsl/reader/parser/lexer.h"
+#include "lang/wgsl/reader/parser/token_stream.h"
+#include "lang/wgsl/reader/parser/token_table.h"
+#include "utils/text/scan.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+// Live and peak bytes allocated through operator new. Every block carries
+// its size in front of it.
+static size_t live_bytes = 0;
+static size_t peak_bytes = 0;
+static constexpr size_t kHeader = alignof(std::max_align_t);
+
+void *operator new(size_t size) {
+  auto *block = static_cast<char *>(std::malloc(size + kHeader));
+  if (!block) {
+    throw std::bad_alloc();
+  }
+  *reinterpret_cast<size_t *>(block) = size;
+  live_bytes += size;
+  peak_bytes = std::max(peak_bytes, live_bytes);
+  return block + kHeader;
+}
+
+void operator delete(void *ptr) noexcept {
+  if (ptr) {
+    char *block = static_cast<char *>(ptr) - kHeader;
+    live_bytes -= *reinterpret_cast<size_t *>(block);
+    std::free(block);
+  }
+}
+
+void operator delete(void *ptr, size_t) noexcept { operator delete(ptr); }
+
+using tint::wgsl::reader::Token;
+
+struct Run {
+  double us = 0.0;
+  size_t peak = 0;
+  std::vector<Token::Type> types;
+};
+
+// Lexes the whole file up front, then walks the tokens like the parser
+static Run Batch(const tint::Source::File &file, bool record) {
+  Run run;
+  size_t base = live_bytes;
+  peak_bytes = live_bytes;
+  auto start = std::chrono::steady_clock::now();
+  {
+    std::vector<Token> tokens = tint::wgsl::reader::Lexer(&file).Lex();
+    for (const Token &token : tokens) {
+      if (record && !token.IsPlaceholder()) {
+        run.types.push_back(token.type());
+      }
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  run.us = std::chrono::duration<double, std::micro>(end - start).count();
+  run.peak = peak_bytes - base;
+  return run;
+}
+
+// Lexes tokens as they are consumed
+static Run Stream(const tint::Source::File &file, bool record) {
+  Run run;
+  size_t base = live_bytes;
+  peak_bytes = live_bytes;
+  auto start = std::chrono::steady_clock::now();
+  {
+    tint::wgsl::reader::TokenStream stream(&file);
+    for (;;) {
+      const Token &token = stream.next();
+      if (record) {
+        run.types.push_back(token.type());
+      }
+      if (token.IsEof() || token.IsError()) {
+        break;
+      }
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  run.us = std::chrono::duration<double, std::micro>(end - start).count();
+  run.peak = peak_bytes - base;
+  return run;
+}
+
+// Lexes the whole file into the compact struct-of-arrays table
+static Run Table(const tint::Source::File &file, bool record) {
+  Run run;
+  size_t base = live_bytes;
+  peak_bytes = live_bytes;
+  auto start = std::chrono::steady_clock::now();
+  {
+    tint::wgsl::reader::TokenTable table(&file);
+    for (size_t i = 0; i < table.Count(); i++) {
+      if (record && table.TypeAt(i) != Token::Type::kPlaceholder) {
+        run.types.push_back(table.TypeAt(i));
+      }
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  run.us = std::chrono::duration<double, std::micro>(end - start).count();
+  run.peak = peak_bytes - base;
+  return run;
+}
+
+// Returns: True if every token of the table has the source of the token the
+//          batch lexer produced
+static bool SourcesMatch(const tint::Source::File &file) {
+  std::vector<Token> tokens = tint::wgsl::reader::Lexer(&file).Lex();
+  tint::wgsl::reader::TokenTable table(&file);
+  if (tokens.size() != table.Count()) {
+    return false;
+  }
+  for (size_t i = 0; i < tokens.size(); i++) {
+    if (!tokens[i].IsPlaceholder() &&
+        tokens[i].source().range != table.SourceAt(i).range) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns: The median of `samples`
+static double Median(std::vector<double> samples) {
+  std::nth_element(samples.begin(), samples.begin() + samples.size() / 2,
+                   samples.end());
+  return samples[samples.size() / 2];
+}
+
+// Matches `word` against every keyword in turn
+static size_t ScanKeywords(std::string_view word) {
+  for (size_t i = 0; i < std::size(tint::wgsl::reader::kKeywordStrings); i++) {
+    if (word == tint::wgsl::reader::kKeywordStrings[i]) {
+      return static_cast<size_t>(tint::wgsl::reader::kKeywordTypes[i]);
+    }
+  }
+  return 0;
+}
+
+static size_t HashKeywords(std::string_view word) {
+  auto type = tint::wgsl::reader::ParseKeyword(word);
+  return type ? static_cast<size_t>(*type) : 0;
+}
+
+static size_t ParseTypes(std::string_view word) {
+  return static_cast<size_t>(tint::core::ParseBuiltinType(word));
+}
+
+static size_t HashTypes(std::string_view word) {
+  return static_cast<size_t>(tint::core::LookupBuiltinType(word));
+}
+
+static size_t ParseFns(std::string_view word) {
+  return static_cast<size_t>(tint::wgsl::ParseBuiltinFn(word));
+}
+
+static size_t HashFns(std::string_view word) {
+  return static_cast<size_t>(tint::wgsl::LookupBuiltinFn(word));
+}
+
+struct Lookup {
+  const char *name;
+  size_t (*compare)(std::string_view);
+  size_t (*hash)(std::string_view);
+};
+
+// Returns: The median time of `iterations` runs of `lookup` over `words`, in
+//          nanoseconds per word
+static double TimeLookup(size_t (*lookup)(std::string_view),
+                         const std::vector<std::string_view> &words,
+                         int iterations, size_t &checksum) {
+  std::vector<double> samples;
+  for (int i = 0; i < iterations; i++) {
+    auto start = std::chrono::steady_clock::now();
+    for (std::string_view word : words) {
+      checksum = checksum * 31 + lookup(word);
+    }
+    auto end = std::chrono::steady_clock::now();
+    samples.push_back(
+        std::chrono::duration<double, std::nano>(end - start).count() /
+        words.size());
+  }
+  return Median(samples);
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <shader dir> [iterations]\n", argv[0]);
+    return 1;
+  }
+  int iterations = argc > 2 ? std::max(1, atoi(argv[2])) : 10;
+
+  std::vector<Shader> shaders = LoadShaders(argv[1]);
+  printf("%-32s %8s %11s %11s %11s %12s %12s %12s\n", "shader", "tokens",
+         "batch (us)", "stream (us)", "table (us)", "batch (KiB)",
+         "stream (KiB)", "table (KiB)");
+
+  bool mismatch = false;
+  std::vector<std::string_view> words;
+  for (const Shader &shader : shaders) {
+    if (shader.format != Format::kWgsl) {
+      continue;
+    }
+    std::string_view text(shader.bytes.data(), shader.bytes.size());
+    for (size_t offset = 0; offset < text.size();) {
+      size_t end = tint::ScanAsciiIdentifier(text, offset);
+      if (end == offset) {
+        offset++;
+        continue;
+      }
+      words.push_back(text.substr(offset, end - offset));
+      offset = end;
+    }
+    tint::Source::File file(
+        shader.name, std::string_view(shader.bytes.data(), shader.bytes.size()));
+
+    Run batch = Batch(file, true);
+    Run stream = Stream(file, true);
+    Run table = Table(file, true);
+    if (batch.types != stream.types || batch.types != table.types) {
+      fprintf(stderr, "%s: token streams differ\n", shader.name.c_str());
+      mismatch = true;
+      continue;
+    }
+    if (!SourcesMatch(file)) {
+      fprintf(stderr, "%s: token table sources differ\n", shader.name.c_str());
+      mismatch = true;
+      continue;
+    }
+
+    std::vector<double> batch_us;
+    std::vector<double> stream_us;
+    std::vector<double> table_us;
+    for (int i = 0; i < iterations; i++) {
+      batch_us.push_back(Batch(file, false).us);
+      stream_us.push_back(Stream(file, false).us);
+      table_us.push_back(Table(file, false).us);
+    }
+    printf("%-32s %8zu %11.1f %11.1f %11.1f %12.1f %12.1f %12.1f\n",
+           shader.name.c_str(), batch.types.size(), Median(batch_us),
+           Median(stream_us), Median(table_us), batch.peak / 1024.0,
+           stream.peak / 1024.0, table.peak / 1024.0);
+  }
+  if (words.empty()) {
+    return mismatch ? 2 : 0;
+  }
+
+  const Lookup lookups[] = {
+      {"keywords", ScanKeywords, HashKeywords},
+      {"builtin types", ParseTypes, HashTypes},
+      {"builtin functions", ParseFns, HashFns},
+  };
+  printf("\n%zu identifier-like words\n", words.size());
+  printf("%-32s %14s %14s %8s\n", "lookup", "compare (ns)", "hash (ns)",
+         "speedup");
+  for (const Lookup &lookup : lookups) {
+    size_t compare_sum = 0;
+    size_t hash_sum = 0;
+    double compare = TimeLookup(lookup.compare, words, iterations, compare_sum);
+    double hash = TimeLookup(lookup.hash, words, iterations, hash_sum);
+    printf("%-32s %14.2f %14.2f %7.2fx\n", lookup.name, compare, hash,
+           compare / hash);
+    if (compare_sum != hash_sum) {
+      fprintf(stderr, "%s: lookups disagree\n", lookup.name);
+      mismatch = true;
+    }
+  }
+  return mismatch ? 2 : 0;
+}
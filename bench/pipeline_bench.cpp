@@ -0,0 +1,127 @@
+// File: bench/pipeline_bench.cpp
+// Author: Kyle Lukaszek
+// Email: kylelukaszek [at] gmail [dot] com
+// Date: 2024-09-21
+// -------------------------------------------------------------
+//
+// License: Apache 2.0 (Follows the same license as Tint)
+//
+// Description: Compares the AST pipeline against the IR pipeline
+//              (TintContextOptions::use_ir) for every shader in
+//              a directory. WGSL files are converted to SPIR-V,
+//              SPIR-V and SPIR-V ASM files are converted to WGSL.
+//
+//              -------------------------------------------------
+//
+//        ->    make bench
+//        ->    node build/pipeline_bench.js <shader dir> [iterations]
+//
+//              -------------------------------------------------
+//
+//              The conversion cache is disabled so that every
+//              iteration runs the whole pipeline. Each shader
+//              reports the median of its iterations.
+//
+// ---------------------------------------------------------------
+
+#include "bench/shaders.h"
+#include "spirv-tools/libspirv.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+// Returns: Median time of `iterations` conversions in microseconds, or a
+//          negative value if the conversion failed
+static double TimeConversion(TintContext *ctx, const Shader &shader,
+                             Format to, int iterations) {
+  std::vector<double> samples;
+  for (int i = 0; i < iterations; i++) {
+    TintOutput out = {};
+    auto start = std::chrono::steady_clock::now();
+    uint32_t status =
+        tint_context_convert(ctx, static_cast<uint32_t>(shader.format),
+                             static_cast<uint32_t>(to), shader.bytes.data(),
+                             shader.Size(), &out);
+    auto end = std::chrono::steady_clock::now();
+    if (status != static_cast<uint32_t>(Status::kSuccess)) {
+      return -1.0;
+    }
+    tint_context_output_free(ctx, out.data);
+    samples.push_back(
+        std::chrono::duration<double, std::micro>(end - start).count());
+  }
+
+  std::nth_element(samples.begin(), samples.begin() + samples.size() / 2,
+                   samples.end());
+  return samples[samples.size() / 2];
+}
+
+// Returns: `us` formatted for the results table
+static std::string Micros(double us) {
+  if (us < 0.0) {
+    return "failed";
+  }
+  char text[32];
+  snprintf(text, sizeof(text), "%.1f", us);
+  return text;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <shader dir> [iterations]\n", argv[0]);
+    return 1;
+  }
+  int iterations = argc > 2 ? std::max(1, atoi(argv[2])) : 10;
+
+  std::vector<Shader> shaders = LoadShaders(argv[1]);
+  if (shaders.empty()) {
+    fprintf(stderr, "No .wgsl, .spv or .spvasm files in %s\n", argv[1]);
+    return 1;
+  }
+
+  // Measure the pipelines, not the cache
+  tint_cache_set_budget(0);
+
+  TintContextOptions ast_options = {SPV_ENV_UNIVERSAL_1_3, 0, 0, 0, 0};
+  TintContextOptions ir_options = ast_options;
+  ir_options.use_ir = 1;
+  TintContext *ast = tint_context_create(&ast_options);
+  TintContext *ir = tint_context_create(&ir_options);
+
+  printf("%-40s %12s %12s %8s\n", "shader", "ast (us)", "ir (us)", "speedup");
+
+  double ast_total = 0.0;
+  double ir_total = 0.0;
+  double log_speedup = 0.0;
+  int compared = 0;
+  for (const Shader &shader : shaders) {
+    Format to = shader.format == Format::kWgsl ? Format::kSpirv : Format::kWgsl;
+    double ast_us = TimeConversion(ast, shader, to, iterations);
+    double ir_us = TimeConversion(ir, shader, to, iterations);
+
+    if (ast_us < 0.0 || ir_us < 0.0) {
+      printf("%-40s %12s %12s %8s\n", shader.name.c_str(),
+             Micros(ast_us).c_str(), Micros(ir_us).c_str(), "-");
+      continue;
+    }
+
+    printf("%-40s %12.1f %12.1f %7.2fx\n", shader.name.c_str(), ast_us, ir_us,
+           ast_us / ir_us);
+    ast_total += ast_us;
+    ir_total += ir_us;
+    log_speedup += std::log(ast_us / ir_us);
+    compared++;
+  }
+
+  if (compared > 0) {
+    printf("\n%-40s %12.1f %12.1f %7.2fx\n", "total", ast_total, ir_total,
+           ast_total / ir_total);
+    printf("%-40s %12s %12s %7.2fx\n", "geomean", "", "",
+           std::exp(log_speedup / compared));
+  }
+
+  tint_context_destroy(ast);
+  tint_context_destroy(ir);
+  return 0;
+}
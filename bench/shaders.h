@@ -0,0 +1,74 @@
+// File: bench/shaders.h
+// Author: Kyle Lukaszek
+// Email: kylelukaszek [at] gmail [dot] com
+// Date: 2024-09-21
+// -------------------------------------------------------------
+//
+// License: Apache 2.0 (Follows the same license as Tint)
+//
+// Description: Shader corpus loading shared by the benchmarks.
+//
+// ---------------------------------------------------------------
+
+#ifndef TINT_WASM_BENCH_SHADERS_H_
+#define TINT_WASM_BENCH_SHADERS_H_
+
+#include "tint_wasm.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+struct Shader {
+  std::string name;
+  Format format;
+  std::vector<char> bytes;
+
+  // Returns: The size to pass to the conversion exports, in words for
+  //          SPIR-V and in bytes for everything else
+  size_t Size() const {
+    return format == Format::kSpirv ? bytes.size() / sizeof(uint32_t)
+                                    : bytes.size();
+  }
+};
+
+// Loads a .wgsl, .spv or .spvasm file. Other files are skipped.
+inline bool LoadShader(const std::filesystem::path &path, Shader &shader) {
+  std::string extension = path.extension().string();
+  if (extension == ".wgsl") {
+    shader.format = Format::kWgsl;
+  } else if (extension == ".spv") {
+    shader.format = Format::kSpirv;
+  } else if (extension == ".spvasm") {
+    shader.format = Format::kSpvAsm;
+  } else {
+    return false;
+  }
+
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  shader.name = path.filename().string();
+  shader.bytes.assign(std::istreambuf_iterator<char>(file),
+                      std::istreambuf_iterator<char>());
+  return true;
+}
+
+// Returns: Every shader in `dir`, sorted by file name
+inline std::vector<Shader> LoadShaders(const std::string &dir) {
+  std::vector<Shader> shaders;
+  for (const auto &entry : std::filesystem::directory_iterator(dir)) {
+    Shader shader;
+    if (entry.is_regular_file() && LoadShader(entry.path(), shader)) {
+      shaders.push_back(std::move(shader));
+    }
+  }
+  std::sort(shaders.begin(), shaders.end(),
+            [](const Shader &a, const Shader &b) { return a.name < b.name; });
+  return shaders;
+}
+
+#endif // TINT_WASM_BENCH_SHADERS_H_
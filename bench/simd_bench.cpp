@@ -0,0 +1,195 @@
+// File: bench/simd_bench.cpp
+// Author: Kyle Lukaszek
+// Email: kylelukaszek [at] gmail [dot] com
+// Date: 2024-09-21
+// -------------------------------------------------------------
+//
+// License: Apache 2.0 (Follows the same license as Tint)
+//
+// Description: Compares the SIMD128 byte kernels in the Tint
+//              headers against their scalar fallbacks on a
+//              directory of shaders.
+//
+//              -------------------------------------------------
+//
+//        ->    make simd-bench
+//        ->    node build/simd_bench.js <shader dir> [iterations]
+//
+//              -------------------------------------------------
+//
+//              The scanning kernels walk the WGSL files the way a
+//              lexer would: blankspace runs, identifiers, and block
+//              comment bodies. Line breaks are found the way a line
+//              index splits a file. Identifiers are hashed one by
+//              one with HashBytes(), and CRC32 runs over every
+//              file. Each kernel reports the
+//              median throughput of its iterations. Built without
+//              -msimd128 both columns run the scalar code.
+//
+// ---------------------------------------------------------------
+
+#include "bench/shaders.h"
+#include "utils/math/crc32.h"
+#include "utils/math/hash.h"
+#include "utils/text/scan.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+
+// Walks `text` like a lexer would: skips blankspace, scans identifiers and
+// steps over everything else one byte at a time.
+// Returns: A checksum of the token boundaries, so the loop isn't removed
+template <bool kSimd> static size_t Lex(std::string_view text) {
+  size_t sum = 0;
+  size_t offset = 0;
+  while (offset < text.size()) {
+    size_t end = kSimd ? tint::SkipAsciiBlankspace(text, offset)
+                       : tint::SkipAsciiBlankspaceScalar(text, offset);
+    if (end == offset) {
+      end = kSimd ? tint::ScanAsciiIdentifier(text, offset)
+                  : tint::ScanAsciiIdentifierScalar(text, offset);
+    }
+    if (end == offset) {
+      end = offset + 1;
+    }
+    sum += end;
+    offset = end;
+  }
+  return sum;
+}
+
+// Jumps from one '*' or '/' to the next, as when skipping a block comment
+template <bool kSimd> static size_t Comments(std::string_view text) {
+  size_t sum = 0;
+  size_t offset = 0;
+  while (offset < text.size()) {
+    offset = kSimd ? tint::FindBlockCommentDelimiter(text, offset)
+                   : tint::FindBlockCommentDelimiterScalar(text, offset);
+    sum += offset++;
+  }
+  return sum;
+}
+
+// Jumps from one possible line break to the next, as when building a line
+// index
+template <bool kSimd> static size_t LineBreaks(std::string_view text) {
+  size_t sum = 0;
+  size_t offset = 0;
+  while (offset < text.size()) {
+    offset = kSimd ? tint::FindLineBreakLead(text, offset)
+                   : tint::FindLineBreakLeadScalar(text, offset);
+    sum += offset++;
+  }
+  return sum;
+}
+
+// Hashes every identifier of `text`
+template <bool kSimd> static size_t HashIdentifiers(std::string_view text) {
+  size_t sum = 0;
+  size_t offset = 0;
+  while (offset < text.size()) {
+    size_t end = tint::ScanAsciiIdentifier(text, offset);
+    if (end == offset) {
+      offset++;
+      continue;
+    }
+    sum += kSimd ? tint::HashBytes(text.data() + offset, end - offset)
+                 : tint::HashBytesScalar(text.data() + offset, end - offset);
+    offset = end;
+  }
+  return sum;
+}
+
+template <bool kSimd> static size_t Crc(std::string_view text) {
+  return kSimd ? tint::CRC32(text.data(), text.size())
+               : tint::CRC32Scalar(text.data(), text.size());
+}
+
+struct Kernel {
+  const char *name;
+  size_t (*scalar)(std::string_view);
+  size_t (*simd)(std::string_view);
+  bool wgsl_only;
+};
+
+// Returns: Median throughput of `iterations` runs of `kernel` over every
+//          input, in MiB per second
+static double Throughput(size_t (*kernel)(std::string_view),
+                         const std::vector<std::string_view> &inputs,
+                         int iterations, size_t &checksum) {
+  size_t bytes = 0;
+  for (std::string_view input : inputs) {
+    bytes += input.size();
+  }
+  std::vector<double> samples;
+  for (int i = 0; i < iterations; i++) {
+    auto start = std::chrono::steady_clock::now();
+    for (std::string_view input : inputs) {
+      checksum += kernel(input);
+    }
+    auto end = std::chrono::steady_clock::now();
+    samples.push_back(std::chrono::duration<double>(end - start).count());
+  }
+  std::nth_element(samples.begin(), samples.begin() + samples.size() / 2,
+                   samples.end());
+  return bytes / (1024.0 * 1024.0) / samples[samples.size() / 2];
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <shader dir> [iterations]\n", argv[0]);
+    return 1;
+  }
+  int iterations = argc > 2 ? std::max(1, atoi(argv[2])) : 20;
+
+  std::vector<Shader> shaders = LoadShaders(argv[1]);
+  std::vector<std::string_view> wgsl;
+  std::vector<std::string_view> all;
+  for (const Shader &shader : shaders) {
+    std::string_view bytes(shader.bytes.data(), shader.bytes.size());
+    all.push_back(bytes);
+    if (shader.format == Format::kWgsl) {
+      wgsl.push_back(bytes);
+    }
+  }
+  if (wgsl.empty()) {
+    fprintf(stderr, "No .wgsl files in %s\n", argv[1]);
+    return 1;
+  }
+
+  const Kernel kernels[] = {
+      {"lexer blankspace + identifiers", Lex<false>, Lex<true>, true},
+      {"block comment delimiters", Comments<false>, Comments<true>, true},
+      {"line breaks", LineBreaks<false>, LineBreaks<true>, true},
+      {"identifier hashing", HashIdentifiers<false>, HashIdentifiers<true>,
+       true},
+      {"crc32", Crc<false>, Crc<true>, false},
+  };
+
+#ifdef __wasm_simd128__
+  printf("SIMD128 kernels, median of %d iterations\n", iterations);
+#else
+  printf("built without -msimd128, both columns are scalar\n");
+#endif
+  printf("%-32s %14s %14s %8s\n", "kernel", "scalar (MiB/s)", "simd (MiB/s)",
+         "speedup");
+
+  size_t scalar_sum = 0;
+  size_t simd_sum = 0;
+  for (const Kernel &kernel : kernels) {
+    const auto &inputs = kernel.wgsl_only ? wgsl : all;
+    double scalar =
+        Throughput(kernel.scalar, inputs, iterations, scalar_sum);
+    double simd = Throughput(kernel.simd, inputs, iterations, simd_sum);
+    printf("%-32s %14.1f %14.1f %7.2fx\n", kernel.name, scalar, simd,
+           simd / scalar);
+  }
+
+  // Both versions have to agree on every token boundary, hash and CRC
+  if (scalar_sum != simd_sum) {
+    fprintf(stderr, "SIMD and scalar kernels disagree\n");
+    return 2;
+  }
+  return 0;
+}
@@ -0,0 +1,98 @@
+// File: bench/size_report.mjs
+// Author: Kyle Lukaszek
+// Email: kylelukaszek [at] gmail [dot] com
+// Date: 2024-09-21
+// -------------------------------------------------------------
+//
+// License: Apache 2.0 (Follows the same license as Tint)
+//
+// Description: Compares the feature-subset builds of the module
+//              by the size of their .wasm and by how long they
+//              take to compile and instantiate.
+//
+//              -------------------------------------------------
+//
+//        ->    make sizes && make sizes LTO=1 && make sizes OPT=-O3
+//        ->    node bench/size_report.mjs [runs] [module.mjs ...]
+//
+//              -------------------------------------------------
+//
+//              Without module arguments every build/tint-*.mjs that
+//              has a .wasm next to it is measured. Sizes are given
+//              raw, gzipped and brotli compressed, as a server would
+//              send them. Compile is WebAssembly.compile() of the
+//              binary alone, instantiate is the module factory up
+//              to a ready module, which compiles the binary again.
+//
+// ---------------------------------------------------------------
+
+import { readFileSync, readdirSync, existsSync } from 'node:fs';
+import { basename, dirname, join, resolve } from 'node:path';
+import { fileURLToPath, pathToFileURL } from 'node:url';
+import { performance } from 'node:perf_hooks';
+import { brotliCompressSync, gzipSync, constants } from 'node:zlib';
+
+const runs = Number(process.argv[2] ?? 10);
+const buildDir = join(dirname(fileURLToPath(import.meta.url)), '..', 'build');
+
+let modules = process.argv.slice(3).map((file) => resolve(file));
+if (modules.length === 0) {
+  modules = readdirSync(buildDir)
+      .filter((file) => file.startsWith('tint-') && file.endsWith('.mjs'))
+      .map((file) => join(buildDir, file))
+      .sort();
+}
+modules = modules.filter((file) => existsSync(file.replace(/\.mjs$/, '.wasm')));
+if (modules.length === 0) {
+  console.error('no modules found, build them with `make sizes`');
+  process.exit(1);
+}
+
+function median(samples) {
+  const sorted = [...samples].sort((a, b) => a - b);
+  return sorted[Math.floor(sorted.length / 2)];
+}
+
+async function measure(file) {
+  const binary = readFileSync(file.replace(/\.mjs$/, '.wasm'));
+  const gzip = gzipSync(binary, { level: 9 }).length;
+  const brotli = brotliCompressSync(binary, {
+    params: { [constants.BROTLI_PARAM_QUALITY]: 11 },
+  }).length;
+
+  const compile = [];
+  for (let i = 0; i < runs; i++) {
+    const start = performance.now();
+    await WebAssembly.compile(binary);
+    compile.push(performance.now() - start);
+  }
+
+  const { default: createModule } = await import(pathToFileURL(file).href);
+  const instantiate = [];
+  for (let i = 0; i < runs; i++) {
+    const start = performance.now();
+    await createModule();
+    instantiate.push(performance.now() - start);
+  }
+
+  return {
+    name: basename(file, '.mjs'),
+    raw: binary.length,
+    gzip,
+    brotli,
+    compile: median(compile),
+    instantiate: median(instantiate),
+  };
+}
+
+const kib = (bytes) => (bytes / 1024).toFixed(1).padStart(10);
+const ms = (value) => value.toFixed(2).padStart(12);
+const width = Math.max(...modules.map((file) => basename(file, '.mjs').length)) + 2;
+
+console.log(`median of ${runs} runs, sizes in KiB, times in ms:`);
+console.log(`${'module'.padEnd(width)}       raw      gzip    brotli     compile  instantiate`);
+for (const file of modules) {
+  const row = await measure(file);
+  console.log(`${row.name.padEnd(width)}${kib(row.raw)}${kib(row.gzip)}${kib(row.brotli)}` +
+              `${ms(row.compile)} ${ms(row.instantiate)}`);
+}
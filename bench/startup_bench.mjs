@@ -0,0 +1,126 @@
+// File: bench/startup_bench.mjs
+// Author: Kyle Lukaszek
+// Email: kylelukaszek [at] gmail [dot] com
+// Date: 2024-09-21
+// -------------------------------------------------------------
+//
+// License: Apache 2.0 (Follows the same license as Tint)
+//
+// Description: Measures how long it takes from instantiating the
+//              module to the end of its first conversion, with
+//              and without calling tint_warmup() in between.
+//
+//              -------------------------------------------------
+//
+//        ->    make startup-bench
+//        ->    node bench/startup_bench.mjs [runs] [shader.wgsl]
+//
+//              -------------------------------------------------
+//
+//              Every run instantiates a fresh module. The very
+//              first instantiation also compiles the WASM binary,
+//              so it is reported on its own as the cold start.
+//              The conversion cache is disabled, and the first
+//              compile is a WGSL -> SPIR-V conversion of the given
+//              shader (a small built-in one by default).
+//
+// ---------------------------------------------------------------
+
+import { readFileSync } from 'node:fs';
+import { performance } from 'node:perf_hooks';
+
+const kWgsl = 4;
+const kSpirv = 2;
+
+const runs = Number(process.argv[2] ?? 20);
+const source = process.argv[3] ? readFileSync(process.argv[3], 'utf8') : `
+struct VertexOutput {
+  @builtin(position) position : vec4f,
+  @location(0) uv : vec2f,
+}
+
+@group(0) @binding(0) var<uniform> transform : mat4x4f;
+@group(0) @binding(1) var color_texture : texture_2d<f32>;
+@group(0) @binding(2) var color_sampler : sampler;
+
+@vertex
+fn vs_main(@location(0) position : vec3f, @location(1) uv : vec2f) -> VertexOutput {
+  var out : VertexOutput;
+  out.position = transform * vec4f(position, 1.0);
+  out.uv = uv;
+  return out;
+}
+
+@fragment
+fn fs_main(in : VertexOutput) -> @location(0) vec4f {
+  let color = textureSample(color_texture, color_sampler, in.uv);
+  return vec4f(pow(color.rgb, vec3f(2.2)), color.a);
+}
+`;
+
+const { default: createModule } = await import('../build/tint-node.mjs');
+
+// Converts `source` once and returns the time it took in milliseconds
+function compile(module) {
+  const size = module.lengthBytesUTF8(source);
+  const input = module._malloc(size + 1);
+  module.stringToUTF8(source, input, size + 1);
+  const out = module._malloc(20);
+  module.HEAPU8.fill(0, out, out + 20);
+
+  const start = performance.now();
+  const status = module._tint_convert(kWgsl, kSpirv, input, size, out);
+  const end = performance.now();
+  if (status !== 0) {
+    throw new Error(`conversion failed with status ${status}`);
+  }
+
+  module._tint_output_free(module.HEAPU32[(out + 8) >> 2]);
+  module._free(out);
+  module._free(input);
+  return end - start;
+}
+
+// Instantiates a module and runs the first conversion on it
+async function run(warmup) {
+  const start = performance.now();
+  const module = await createModule();
+  const instantiated = performance.now();
+  module._tint_cache_set_budget(0);
+  if (warmup && module._tint_warmup() !== 0) {
+    throw new Error('tint_warmup() failed');
+  }
+  const warmed = performance.now();
+  const first = compile(module);
+  const second = compile(module);
+  return {
+    instantiate: instantiated - start,
+    warmup: warmed - instantiated,
+    first,
+    second,
+    total: warmed - start + first,
+  };
+}
+
+function median(samples) {
+  const sorted = [...samples].sort((a, b) => a - b);
+  return sorted[Math.floor(sorted.length / 2)];
+}
+
+const cold = await run(false);
+const results = { cold: [], warm: [] };
+for (let i = 0; i < runs; i++) {
+  results.cold.push(await run(false));
+  results.warm.push(await run(true));
+}
+
+const ms = (value) => value.toFixed(2).padStart(10);
+console.log(`cold start: instantiate ${cold.instantiate.toFixed(2)} ms, ` +
+            `first compile ${cold.first.toFixed(2)} ms`);
+console.log(`median of ${runs} runs, in ms:`);
+console.log('               instantiate    warmup  1st compile  2nd compile  to 1st result');
+for (const [name, samples] of [['no warmup', results.cold], ['tint_warmup()', results.warm]]) {
+  const column = (key) => ms(median(samples.map((sample) => sample[key])));
+  console.log(`${name.padEnd(14)}${column('instantiate')}${column('warmup')}` +
+              `${column('first')}   ${column('second')}  ${column('total')}`);
+}
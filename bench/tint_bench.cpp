@@ -0,0 +1,350 @@
+// File: bench/tint_bench.cpp
+// Author: Kyle Lukaszek
+// Email: kylelukaszek [at] gmail [dot] com
+// Date: 2024-09-21
+// -------------------------------------------------------------
+//
+// License: Apache 2.0 (Follows the same license as Tint)
+//
+// Description: Latency benchmark of the conversion API for native
+//              Linux builds. Every shader in a directory is
+//              converted in every direction its format supports:
+//
+//                WGSL         -> SPIR-V, SPIR-V ASM
+//                SPIR-V       -> SPIR-V ASM, WGSL
+//                SPIR-V ASM   -> SPIR-V, WGSL
+//
+//              -------------------------------------------------
+//
+//        ->    make native
+//        ->    build/native/tint_bench <shader dir> [iterations]
+//                  [--ir] [--json] [--phases]
+//
+//              -------------------------------------------------
+//
+//              The conversion cache is disabled so that every
+//              iteration runs the whole pipeline. Reports p50,
+//              p90 and p99 latency per shader and per direction,
+//              throughput, and the peak RSS of the process.
+//              --json prints the same numbers as a single JSON
+//              document on stdout for CI to compare.
+//
+//              Each shader also reports the peak_bytes of its
+//              TintMemoryStats, the memory held by Tint's arenas.
+//
+//              --phases also reports where the time went, per
+//              compile phase. Profiling lexes WGSL and runs the
+//              AST transforms of the SPIR-V writer a second time,
+//              so the latencies come out slightly higher with it.
+//
+// ---------------------------------------------------------------
+
+#include "bench/shaders.h"
+#include "spirv-tools/libspirv.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/resource.h>
+
+struct Direction {
+  Format from;
+  Format to;
+  const char *name;
+};
+
+static const Direction kDirections[] = {
+    {Format::kWgsl, Format::kSpirv, "wgsl->spirv"},
+    {Format::kWgsl, Format::kSpvAsm, "wgsl->spvasm"},
+    {Format::kSpirv, Format::kSpvAsm, "spirv->spvasm"},
+    {Format::kSpirv, Format::kWgsl, "spirv->wgsl"},
+    {Format::kSpvAsm, Format::kSpirv, "spvasm->spirv"},
+    {Format::kSpvAsm, Format::kWgsl, "spvasm->wgsl"},
+};
+
+// Latency samples of one shader in one direction, in microseconds
+struct Run {
+  const Shader *shader;
+  const Direction *direction;
+  bool failed;
+  uint32_t arena_bytes;
+  std::vector<double> samples;
+};
+
+// Returns: The `p`th percentile (nearest rank) of sorted `samples`
+static double Percentile(const std::vector<double> &samples, double p) {
+  if (samples.empty()) {
+    return 0.0;
+  }
+  size_t rank = static_cast<size_t>(p / 100.0 * (samples.size() - 1) + 0.5);
+  return samples[std::min(rank, samples.size() - 1)];
+}
+
+// Converts `shader` once untimed to warm up, then `iterations` times.
+// Returns: The run, with its samples sorted
+static Run TimeConversion(TintContext *ctx, const Shader &shader,
+                          const Direction &direction, int iterations) {
+  Run run = {&shader, &direction, false, 0, {}};
+  for (int i = -1; i < iterations; i++) {
+    TintOutput out = {};
+    auto start = std::chrono::steady_clock::now();
+    uint32_t status =
+        tint_context_convert(ctx, static_cast<uint32_t>(direction.from),
+                             static_cast<uint32_t>(direction.to),
+                             shader.bytes.data(), shader.Size(), &out);
+    auto end = std::chrono::steady_clock::now();
+    if (status != static_cast<uint32_t>(Status::kSuccess)) {
+      run.failed = true;
+      run.samples.clear();
+      return run;
+    }
+    tint_context_output_free(ctx, out.data);
+
+    TintMemoryStats memory;
+    tint_context_memory_stats(ctx, &memory);
+    run.arena_bytes = memory.peak_bytes;
+    if (i >= 0) {
+      run.samples.push_back(
+          std::chrono::duration<double, std::micro>(end - start).count());
+    }
+  }
+  std::sort(run.samples.begin(), run.samples.end());
+  return run;
+}
+
+// Returns: Peak resident set size of the process in KiB
+static long PeakRssKiB() {
+  struct rusage usage = {};
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+// Returns: `text` as a quoted JSON string
+static std::string JsonString(const std::string &text) {
+  std::string out = "\"";
+  for (char c : text) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char escape[8];
+      snprintf(escape, sizeof(escape), "\\u%04x", c);
+      out += escape;
+    } else {
+      out += c;
+    }
+  }
+  return out + "\"";
+}
+
+// Aggregate of every run in one direction
+struct Summary {
+  const Direction *direction;
+  int shaders;
+  int failures;
+  size_t input_bytes;
+  std::vector<double> samples;
+
+  double TotalSeconds() const {
+    double total = 0.0;
+    for (double us : samples) {
+      total += us;
+    }
+    return total / 1e6;
+  }
+
+  // Returns: Conversions per second
+  double Throughput() const {
+    double seconds = TotalSeconds();
+    return seconds > 0.0 ? samples.size() / seconds : 0.0;
+  }
+
+  // Returns: Input MiB converted per second
+  double Bandwidth(int iterations) const {
+    double seconds = TotalSeconds();
+    return seconds > 0.0
+               ? input_bytes * iterations / (1024.0 * 1024.0) / seconds
+               : 0.0;
+  }
+};
+
+// Returns: The phases of `ctx` that ran at least once
+static std::vector<TintPhaseStats> RanPhases(TintContext *ctx) {
+  uint32_t count = 0;
+  const TintPhaseStats *stats = tint_context_phase_stats(ctx, &count);
+  std::vector<TintPhaseStats> phases;
+  for (uint32_t i = 0; i < count; i++) {
+    if (stats[i].calls > 0) {
+      phases.push_back(stats[i]);
+    }
+  }
+  return phases;
+}
+
+static void PrintText(const std::vector<Run> &runs,
+                      const std::vector<Summary> &summaries,
+                      const std::vector<TintPhaseStats> &phases,
+                      int iterations) {
+  printf("%-40s %-14s %10s %10s %10s %12s\n", "shader", "direction",
+         "p50 (us)", "p90 (us)", "p99 (us)", "arena (KiB)");
+  for (const Run &run : runs) {
+    if (run.failed) {
+      printf("%-40s %-14s %10s %10s %10s %12s\n", run.shader->name.c_str(),
+             run.direction->name, "failed", "-", "-", "-");
+      continue;
+    }
+    printf("%-40s %-14s %10.1f %10.1f %10.1f %12u\n",
+           run.shader->name.c_str(), run.direction->name,
+           Percentile(run.samples, 50), Percentile(run.samples, 90),
+           Percentile(run.samples, 99), run.arena_bytes / 1024);
+  }
+
+  printf("\n%-14s %7s %8s %10s %10s %10s %12s %10s\n", "direction", "shaders",
+         "failures", "p50 (us)", "p90 (us)", "p99 (us)", "conv/s", "MiB/s");
+  for (const Summary &summary : summaries) {
+    printf("%-14s %7d %8d %10.1f %10.1f %10.1f %12.1f %10.2f\n",
+           summary.direction->name, summary.shaders, summary.failures,
+           Percentile(summary.samples, 50), Percentile(summary.samples, 90),
+           Percentile(summary.samples, 99), summary.Throughput(),
+           summary.Bandwidth(iterations));
+  }
+  if (!phases.empty()) {
+    printf("\n%-24s %8s %12s %10s %10s\n", "phase", "calls", "total (ms)",
+           "avg (us)", "max (us)");
+    for (const TintPhaseStats &phase : phases) {
+      printf("%-24s %8u %12.2f %10.1f %10.1f\n", phase.name, phase.calls,
+             phase.total_us / 1000.0, phase.total_us / phase.calls,
+             phase.max_us);
+    }
+  }
+  printf("\npeak rss: %ld KiB\n", PeakRssKiB());
+}
+
+static void PrintJson(const std::vector<Run> &runs,
+                      const std::vector<Summary> &summaries,
+                      const std::vector<TintPhaseStats> &phases,
+                      int iterations, bool use_ir) {
+  printf("{\n  \"iterations\": %d,\n  \"pipeline\": \"%s\",\n", iterations,
+         use_ir ? "ir" : "ast");
+  printf("  \"peak_rss_kib\": %ld,\n  \"shaders\": [", PeakRssKiB());
+  for (size_t i = 0; i < runs.size(); i++) {
+    const Run &run = runs[i];
+    printf("%s\n    {\"name\": %s, \"direction\": \"%s\", \"input_bytes\": %zu, "
+           "\"failed\": %s",
+           i ? "," : "", JsonString(run.shader->name).c_str(),
+           run.direction->name, run.shader->bytes.size(),
+           run.failed ? "true" : "false");
+    if (!run.failed) {
+      printf(", \"p50_us\": %.2f, \"p90_us\": %.2f, \"p99_us\": %.2f, "
+             "\"min_us\": %.2f, \"max_us\": %.2f, \"arena_bytes\": %u",
+             Percentile(run.samples, 50), Percentile(run.samples, 90),
+             Percentile(run.samples, 99), run.samples.front(),
+             run.samples.back(), run.arena_bytes);
+    }
+    printf("}");
+  }
+  printf("\n  ],\n  \"directions\": [");
+  for (size_t i = 0; i < summaries.size(); i++) {
+    const Summary &summary = summaries[i];
+    printf("%s\n    {\"direction\": \"%s\", \"shaders\": %d, \"failures\": %d, "
+           "\"p50_us\": %.2f, \"p90_us\": %.2f, \"p99_us\": %.2f, "
+           "\"conversions_per_sec\": %.2f, \"mib_per_sec\": %.3f}",
+           i ? "," : "", summary.direction->name, summary.shaders,
+           summary.failures, Percentile(summary.samples, 50),
+           Percentile(summary.samples, 90), Percentile(summary.samples, 99),
+           summary.Throughput(), summary.Bandwidth(iterations));
+  }
+  printf("\n  ],\n  \"phases\": [");
+  for (size_t i = 0; i < phases.size(); i++) {
+    printf("%s\n    {\"phase\": \"%s\", \"calls\": %u, \"total_us\": %.2f, "
+           "\"max_us\": %.2f}",
+           i ? "," : "", phases[i].name, phases[i].calls, phases[i].total_us,
+           phases[i].max_us);
+  }
+  printf("\n  ]\n}\n");
+}
+
+int main(int argc, char **argv) {
+  const char *dir = nullptr;
+  int iterations = 20;
+  bool use_ir = false;
+  bool json = false;
+  bool phases = false;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--ir") == 0) {
+      use_ir = true;
+    } else if (strcmp(argv[i], "--json") == 0) {
+      json = true;
+    } else if (strcmp(argv[i], "--phases") == 0) {
+      phases = true;
+    } else if (!dir) {
+      dir = argv[i];
+    } else {
+      iterations = std::max(1, atoi(argv[i]));
+    }
+  }
+  if (!dir) {
+    fprintf(stderr,
+            "usage: %s <shader dir> [iterations] [--ir] [--json] [--phases]\n",
+            argv[0]);
+    return 1;
+  }
+
+  std::vector<Shader> shaders = LoadShaders(dir);
+  if (shaders.empty()) {
+    fprintf(stderr, "No .wgsl, .spv or .spvasm files in %s\n", dir);
+    return 1;
+  }
+
+  // Measure the pipelines, not the cache
+  tint_cache_set_budget(0);
+
+  TintContextOptions options = {SPV_ENV_UNIVERSAL_1_3, 0, 0, 0, 0};
+  options.use_ir = use_ir ? 1 : 0;
+  TintContext *ctx = tint_context_create(&options);
+  if (phases) {
+    tint_context_set_profiling(ctx, kTintProfileStats);
+  }
+
+  std::vector<Run> runs;
+  std::vector<Summary> summaries;
+  for (const Direction &direction : kDirections) {
+    Summary summary = {&direction, 0, 0, 0, {}};
+    for (const Shader &shader : shaders) {
+      if (shader.format != direction.from) {
+        continue;
+      }
+      runs.push_back(TimeConversion(ctx, shader, direction, iterations));
+      const Run &run = runs.back();
+      summary.shaders++;
+      if (run.failed) {
+        summary.failures++;
+        continue;
+      }
+      summary.input_bytes += shader.bytes.size();
+      summary.samples.insert(summary.samples.end(), run.samples.begin(),
+                             run.samples.end());
+    }
+    if (summary.shaders > 0) {
+      std::sort(summary.samples.begin(), summary.samples.end());
+      summaries.push_back(std::move(summary));
+    }
+  }
+
+  std::vector<TintPhaseStats> phase_stats = RanPhases(ctx);
+  tint_context_destroy(ctx);
+
+  if (json) {
+    PrintJson(runs, summaries, phase_stats, iterations, use_ir);
+  } else {
+    PrintText(runs, summaries, phase_stats, iterations);
+  }
+
+  // Non-zero exit so that CI notices shaders that stopped converting
+  for (const Summary &summary : summaries) {
+    if (summary.failures > 0) {
+      return 2;
+    }
+  }
+  return 0;
+}
@@ -90,6 +90,10 @@ class Manager final {
         return values_.Get<NODE>(std::forward<ARGS>(args)...);
     }
 
+    /// @returns the heap memory held by the constant values owned by the manager, excluding
+    /// #types
+    AllocatorStats Stats() const { return values_.Stats(); }
+
     /// @returns an iterator to the beginning of the types
     TypeIterator begin() const { return values_.begin(); }
     /// @returns an iterator to the end of the types
@@ -526,6 +526,14 @@ class Manager final {
         return Struct(name, tint::Vector<StructMemberDesc, 4>(members));
     }
 
+    /// @returns the heap memory held by the types and nodes owned by the manager
+    AllocatorStats Stats() const {
+        AllocatorStats stats = types_.Stats();
+        stats += unique_nodes_.Stats();
+        stats += nodes_.Stats();
+        return stats;
+    }
+
     /// @returns an iterator to the beginning of the types
     TypeIterator begin() const { return types_.begin(); }
     /// @returns an iterator to the end of the types
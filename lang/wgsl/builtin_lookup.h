@@ -0,0 +1,58 @@
+// Copyright 2024 The Dawn & Tint Authors
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SRC_TINT_LANG_WGSL_BUILTIN_LOOKUP_H_
+#define SRC_TINT_LANG_WGSL_BUILTIN_LOOKUP_H_
+
+#include <iterator>
+#include <string_view>
+
+#include "lang/wgsl/builtin_fn.h"
+#include "utils/text/perfect_hash.h"
+
+namespace tint::wgsl {
+
+static_assert(std::size(kBuiltinFnStrings) == std::size(kBuiltinFns),
+              "kBuiltinFnStrings and kBuiltinFns must be parallel");
+
+/// The perfect hash of kBuiltinFnStrings
+inline constexpr PerfectHash kBuiltinFnHash{kBuiltinFnStrings};
+
+/// Perfect hash lookup of a WGSL builtin function, which returns the same value as
+/// ParseBuiltinFn() without comparing @p name against every builtin name.
+/// @param name the builtin name to look up
+/// @returns the BuiltinFn named @p name, or BuiltinFn::kNone if there is none
+constexpr BuiltinFn LookupBuiltinFn(std::string_view name) {
+    if (auto index = kBuiltinFnHash.Find(name)) {
+        return kBuiltinFns[*index];
+    }
+    return BuiltinFn::kNone;
+}
+
+}  // namespace tint::wgsl
+
+#endif  // SRC_TINT_LANG_WGSL_BUILTIN_LOOKUP_H_
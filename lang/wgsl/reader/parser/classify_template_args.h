@@ -28,14 +28,122 @@
 #ifndef SRC_TINT_LANG_WGSL_READER_PARSER_CLASSIFY_TEMPLATE_ARGS_H_
 #define SRC_TINT_LANG_WGSL_READER_PARSER_CLASSIFY_TEMPLATE_ARGS_H_
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 #include "lang/wgsl/reader/parser/token.h"
+#include "utils/containers/vector.h"
 
 namespace tint::wgsl::reader {
 
 void ClassifyTemplateArguments(std::vector<Token>& tokens);
 
+/// TemplateArgumentClassifier is ClassifyTemplateArguments() one token at a time, for token stores
+/// that are filled as they are parsed or that don't hold a std::vector<Token>. The store is passed
+/// as `TOKENS`, which must have the methods `Token::Type TypeAt(size_t index)` and
+/// `void SetTypeAt(size_t index, Token::Type type)`.
+class TemplateArgumentClassifier {
+  public:
+    /// Classifies the token at `index`. As in ClassifyTemplateArguments(), the token after it must
+    /// already be in `tokens`, and the last token is never classified.
+    /// @param tokens the token store
+    /// @param index the index of the token to classify
+    /// @returns the index of the next token to classify
+    template <typename TOKENS>
+    size_t Classify(TOKENS& tokens, size_t index) {
+        Token::Type type = tokens.TypeAt(index);
+        switch (type) {
+            case Token::Type::kIdentifier:
+            case Token::Type::kVar:
+                if (tokens.TypeAt(index + 1) == Token::Type::kLessThan) {
+                    // ident '<'
+                    candidates_.Push(Candidate{index + 1, expr_depth_});
+                    return index + 2;
+                }
+                break;
+            case Token::Type::kGreaterThan:
+            case Token::Type::kShiftRight:
+            case Token::Type::kGreaterThanEqual:
+            case Token::Type::kShiftRightEqual:
+                if (!candidates_.IsEmpty() && candidates_.Back().expr_depth == expr_depth_) {
+                    // '<' and '>' at the same expression depth, without terminating tokens in
+                    // between. Split off the '>' into a template list.
+                    switch (type) {
+                        case Token::Type::kShiftRight:
+                            tokens.SetTypeAt(index + 1, Token::Type::kGreaterThan);
+                            break;
+                        case Token::Type::kGreaterThanEqual:
+                            tokens.SetTypeAt(index + 1, Token::Type::kEqual);
+                            break;
+                        case Token::Type::kShiftRightEqual:
+                            tokens.SetTypeAt(index + 1, Token::Type::kGreaterThanEqual);
+                            break;
+                        default:
+                            break;
+                    }
+                    tokens.SetTypeAt(candidates_.Pop().index, Token::Type::kTemplateArgsLeft);
+                    tokens.SetTypeAt(index, Token::Type::kTemplateArgsRight);
+                }
+                break;
+            case Token::Type::kParenLeft:
+            case Token::Type::kBracketLeft:
+                expr_depth_++;
+                break;
+            case Token::Type::kParenRight:
+            case Token::Type::kBracketRight:
+                PopCandidatesAtDepth();
+                if (expr_depth_ > 0) {
+                    expr_depth_--;
+                }
+                break;
+            case Token::Type::kSemicolon:
+            case Token::Type::kBraceLeft:
+            case Token::Type::kEqual:
+            case Token::Type::kColon:
+                // Expression terminators, no template list can span them
+                expr_depth_ = 0;
+                candidates_.Clear();
+                break;
+            case Token::Type::kOrOr:
+            case Token::Type::kAndAnd:
+                // 'a < b || c > d' is two comparisons, not a template list
+                PopCandidatesAtDepth();
+                break;
+            default:
+                break;
+        }
+        return index + 1;
+    }
+
+    /// @returns true if a '<' is still undecided
+    bool HasUndecided() const { return !candidates_.IsEmpty(); }
+
+    /// @returns the index of the first '<' that is still undecided. Only valid if HasUndecided().
+    size_t FirstUndecided() const { return candidates_[0].index; }
+
+  private:
+    /// An undecided '<'
+    struct Candidate {
+        /// The index of the '<' token
+        size_t index;
+        /// The expression depth the '<' appeared at
+        uint64_t expr_depth;
+    };
+
+    /// Drops the candidates of the current expression depth
+    void PopCandidatesAtDepth() {
+        while (!candidates_.IsEmpty() && candidates_.Back().expr_depth == expr_depth_) {
+            candidates_.Pop();
+        }
+    }
+
+    /// The undecided '<' tokens, innermost last
+    Vector<Candidate, 16> candidates_;
+    /// The current expression nesting depth
+    uint64_t expr_depth_ = 0;
+};
+
 }  // namespace tint::wgsl::reader
 
 #endif  // SRC_TINT_LANG_WGSL_READER_PARSER_CLASSIFY_TEMPLATE_ARGS_H_
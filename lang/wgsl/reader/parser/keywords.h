@@ -0,0 +1,121 @@
+// Copyright 2024 The Dawn & Tint Authors
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SRC_TINT_LANG_WGSL_READER_PARSER_KEYWORDS_H_
+#define SRC_TINT_LANG_WGSL_READER_PARSER_KEYWORDS_H_
+
+#include <iterator>
+#include <optional>
+#include <string_view>
+
+#include "lang/wgsl/reader/parser/token.h"
+#include "utils/text/perfect_hash.h"
+
+namespace tint::wgsl::reader {
+
+/// The words the lexer matches as keywords. This includes the reserved word 'fallthrough', see
+/// Token::Type::kFallthrough.
+constexpr std::string_view kKeywordStrings[] = {
+    "alias",
+    "break",
+    "case",
+    "const",
+    "const_assert",
+    "continue",
+    "continuing",
+    "default",
+    "diagnostic",
+    "discard",
+    "else",
+    "enable",
+    "fallthrough",
+    "false",
+    "fn",
+    "for",
+    "if",
+    "let",
+    "loop",
+    "override",
+    "requires",
+    "return",
+    "struct",
+    "switch",
+    "true",
+    "var",
+    "while",
+};
+
+/// The token types of kKeywordStrings, in the same order
+constexpr Token::Type kKeywordTypes[] = {
+    Token::Type::kAlias,
+    Token::Type::kBreak,
+    Token::Type::kCase,
+    Token::Type::kConst,
+    Token::Type::kConstAssert,
+    Token::Type::kContinue,
+    Token::Type::kContinuing,
+    Token::Type::kDefault,
+    Token::Type::kDiagnostic,
+    Token::Type::kDiscard,
+    Token::Type::kElse,
+    Token::Type::kEnable,
+    Token::Type::kFallthrough,
+    Token::Type::kFalse,
+    Token::Type::kFn,
+    Token::Type::kFor,
+    Token::Type::kIf,
+    Token::Type::kLet,
+    Token::Type::kLoop,
+    Token::Type::kOverride,
+    Token::Type::kRequires,
+    Token::Type::kReturn,
+    Token::Type::kStruct,
+    Token::Type::kSwitch,
+    Token::Type::kTrue,
+    Token::Type::kVar,
+    Token::Type::kWhile,
+};
+
+static_assert(std::size(kKeywordStrings) == std::size(kKeywordTypes));
+
+/// The perfect hash of kKeywordStrings
+inline constexpr PerfectHash kKeywordHash{kKeywordStrings};
+
+/// Matches a keyword with one hash lookup and one string comparison. Identifiers shorter or longer
+/// than every keyword are rejected by their length alone.
+/// @param str the identifier-like text of a token
+/// @returns the keyword token type of @p str, or std::nullopt if @p str is not a keyword
+constexpr std::optional<Token::Type> ParseKeyword(std::string_view str) {
+    if (auto index = kKeywordHash.Find(str)) {
+        return kKeywordTypes[*index];
+    }
+    return std::nullopt;
+}
+
+}  // namespace tint::wgsl::reader
+
+#endif  // SRC_TINT_LANG_WGSL_READER_PARSER_KEYWORDS_H_
@@ -46,6 +46,11 @@ class Lexer {
     /// @return the token list.
     std::vector<Token> Lex();
 
+    /// Lexes a single token, for TokenStream. Unlike Lex(), this inserts no placeholder tokens
+    /// after the token and does not classify template arguments.
+    /// @return the next token in the input stream
+    Token Next() { return next(); }
+
   private:
     /// Returns the next token in the input stream.
     /// @return Token
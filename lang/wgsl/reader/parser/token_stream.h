@@ -0,0 +1,225 @@
+// Copyright 2024 The Dawn & Tint Authors
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SRC_TINT_LANG_WGSL_READER_PARSER_TOKEN_STREAM_H_
+#define SRC_TINT_LANG_WGSL_READER_PARSER_TOKEN_STREAM_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "lang/wgsl/reader/parser/classify_template_args.h"
+#include "lang/wgsl/reader/parser/lexer.h"
+#include "lang/wgsl/reader/parser/token.h"
+
+namespace tint::wgsl::reader {
+
+/// TokenStream lexes tokens on demand into a bounded ring buffer, instead of lexing the whole file
+/// up front like Lexer::Lex(). It yields the same tokens as Lex(), including the placeholders that
+/// follow splittable tokens and the template argument lists found by ClassifyTemplateArguments().
+///
+/// ClassifyTemplateArguments() may turn a '<' into a kTemplateArgsLeft long after the '<' was
+/// lexed, so tokens are only handed out once no '<' before them is still undecided. The buffer
+/// therefore has to hold the lookahead of the parser plus the longest undecided template list. The
+/// default capacity covers that for any sensibly written shader. If an expression keeps a '<'
+/// undecided for longer, the buffer grows rather than giving a different result than Lex().
+class TokenStream {
+  public:
+    /// The furthest the parser peeks ahead of the next token
+    static constexpr size_t kMaxLookahead = 4;
+    /// The number of tokens kept after they were handed out, so that references returned by
+    /// next() stay valid while the parser looks back at them
+    static constexpr size_t kHistory = 8;
+    /// The default number of tokens in the ring buffer
+    static constexpr size_t kDefaultCapacity = 64;
+
+    /// Constructor
+    /// @param file the source file
+    /// @param capacity the initial number of tokens in the ring buffer, rounded up to a power of
+    /// two that can hold the lookahead and history
+    explicit TokenStream(const Source::File* file, size_t capacity = kDefaultCapacity)
+        : lexer_(file) {
+        size_t size = 1;
+        while (size < capacity || size < kHistory + kMaxLookahead + kMaxTokensPerLex) {
+            size *= 2;
+        }
+        ring_.resize(size);
+    }
+
+    /// Consumes the next token. Placeholder tokens are skipped, and once the end of the input or
+    /// an error is reached, that token is returned over and over.
+    /// @returns the next token. The reference stays valid for kHistory more calls to next(), as
+    /// long as the ring buffer doesn't have to grow in the meantime.
+    const Token& next() {
+        for (;;) {
+            const Token& token = At(cursor_);
+            if (token.IsEof() || token.IsError()) {
+                return token;
+            }
+            cursor_++;
+            if (!token.IsPlaceholder()) {
+                return token;
+            }
+        }
+    }
+
+    /// @param idx the number of tokens to look past, not counting placeholders
+    /// @returns the token `idx` positions after the next token, without consuming anything. Past
+    /// the end of the input this is the end of file (or error) token.
+    const Token& peek(size_t idx = 0) {
+        for (size_t i = cursor_;; i++) {
+            const Token& token = At(i);
+            if (token.IsEof() || token.IsError()) {
+                return token;
+            }
+            if (!token.IsPlaceholder()) {
+                if (idx == 0) {
+                    return token;
+                }
+                idx--;
+            }
+        }
+    }
+
+    /// @param type the token type to look for
+    /// @param idx the number of tokens to look past, not counting placeholders
+    /// @returns true if the token `idx` positions after the next token is of type `type`
+    bool peek_is(Token::Type type, size_t idx = 0) { return peek(idx).Is(type); }
+
+    /// @returns the current number of tokens in the ring buffer
+    size_t Capacity() const { return ring_.size(); }
+
+    /// @returns the most tokens that were held in the ring buffer at once
+    size_t MaxBuffered() const { return max_buffered_; }
+
+  private:
+    /// The most tokens a single Lexer::Next() call produces, the token plus its placeholders
+    static constexpr size_t kMaxTokensPerLex = 3;
+
+    /// The token store the TemplateArgumentClassifier works on
+    struct Ring {
+        /// @returns the type of the token at `index`
+        Token::Type TypeAt(size_t index) { return stream.Slot(index).type(); }
+        /// Sets the type of the token at `index`
+        void SetTypeAt(size_t index, Token::Type type) { stream.Slot(index).SetType(type); }
+        /// The stream
+        TokenStream& stream;
+    };
+
+    /// @param index the absolute index of the token
+    /// @returns the token at `index`, lexing until it can no longer change
+    const Token& At(size_t index) {
+        while (index >= Decided()) {
+            if (done_) {
+                return *ring_[(end_ - 1) & (ring_.size() - 1)];
+            }
+            Lex();
+        }
+        return *ring_[index & (ring_.size() - 1)];
+    }
+
+    /// @returns the index of the first token that may still change
+    size_t Decided() const {
+        if (done_) {
+            return end_;
+        }
+        return classifier_.HasUndecided() ? std::min(classified_, classifier_.FirstUndecided())
+                                          : classified_;
+    }
+
+    /// Lexes the next token into the ring buffer, followed by its placeholders, and classifies
+    /// template arguments as far as possible.
+    void Lex() {
+        size_t oldest = cursor_ > kHistory ? cursor_ - kHistory : 0;
+        if (end_ - oldest + kMaxTokensPerLex > ring_.size()) {
+            Grow(oldest);
+        }
+
+        Token token = lexer_.Next();
+        size_t placeholders = token.NumPlaceholders();
+        bool last = token.IsEof() || token.IsError();
+        Source source = token.source();
+        Push(std::move(token));
+        for (size_t i = 0; i < placeholders; i++) {
+            source.range.begin.column++;
+            Push(Token(Token::Type::kPlaceholder, source));
+        }
+        max_buffered_ = std::max(max_buffered_, end_ - oldest);
+
+        // As in ClassifyTemplateArguments(), every token but the last one is classified, and a
+        // token is only classified once the token after it exists.
+        Ring ring{*this};
+        while (classified_ + 1 < end_) {
+            classified_ = classifier_.Classify(ring, classified_);
+        }
+        if (last) {
+            done_ = true;
+        }
+    }
+
+    /// Appends `token` to the ring buffer
+    void Push(Token&& token) {
+        ring_[end_ & (ring_.size() - 1)].emplace(std::move(token));
+        end_++;
+    }
+
+    /// Doubles the ring buffer, keeping the tokens from `oldest` on
+    void Grow(size_t oldest) {
+        std::vector<std::optional<Token>> ring(ring_.size() * 2);
+        for (size_t i = oldest; i < end_; i++) {
+            ring[i & (ring.size() - 1)].emplace(std::move(*ring_[i & (ring_.size() - 1)]));
+        }
+        ring_ = std::move(ring);
+    }
+
+    /// @returns the token at the absolute index `index`, which must be in the ring buffer
+    Token& Slot(size_t index) { return *ring_[index & (ring_.size() - 1)]; }
+
+    /// The lexer producing the tokens
+    Lexer lexer_;
+    /// The ring buffer, indexed by the absolute token index modulo its size
+    std::vector<std::optional<Token>> ring_;
+    /// The absolute index of the next token to hand out
+    size_t cursor_ = 0;
+    /// The number of tokens lexed so far
+    size_t end_ = 0;
+    /// The absolute index of the next token to classify
+    size_t classified_ = 0;
+    /// True once the end of file or an error token was lexed
+    bool done_ = false;
+    /// Classifies template arguments as tokens arrive
+    TemplateArgumentClassifier classifier_;
+    /// See MaxBuffered()
+    size_t max_buffered_ = 0;
+};
+
+}  // namespace tint::wgsl::reader
+
+#endif  // SRC_TINT_LANG_WGSL_READER_PARSER_TOKEN_STREAM_H_
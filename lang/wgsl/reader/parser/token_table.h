@@ -0,0 +1,287 @@
+// Copyright 2024 The Dawn & Tint Authors
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SRC_TINT_LANG_WGSL_READER_PARSER_TOKEN_TABLE_H_
+#define SRC_TINT_LANG_WGSL_READER_PARSER_TOKEN_TABLE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "lang/wgsl/reader/parser/classify_template_args.h"
+#include "lang/wgsl/reader/parser/lexer.h"
+#include "lang/wgsl/reader/parser/token.h"
+#include "utils/containers/hashmap.h"
+#include "utils/diagnostic/line_index.h"
+
+namespace tint::wgsl::reader {
+
+/// TokenTable holds the tokens of a file as a struct of arrays, 9 bytes per token instead of a
+/// Token each: a 1 byte type, and the 32-bit byte offset and length of the token in the file.
+/// Identifiers are slices of the file, so they need nothing more. Literal values and error
+/// messages go into a side table, with equal values stored once.
+///
+/// Lines and columns are not stored. SourceAt() works them out from the offsets, with a line index
+/// that is only built the first time a Source is asked for, which in a clean parse is never.
+///
+/// The tokens are the same as the ones of Lexer::Lex(), including placeholders and classified
+/// template arguments.
+class TokenTable {
+  public:
+    /// Constructor. Lexes the whole of `file`.
+    /// @param file the source file, which must be smaller than 4 GiB and outlive the table
+    explicit TokenTable(const Source::File* file) : file_(file), lines_(file->content.data) {
+        Lexer lexer(file);
+        TemplateArgumentClassifier classifier;
+        size_t classified = 0;
+        for (;;) {
+            Token token = lexer.Next();
+            size_t index = Append(token);
+            for (size_t i = 0; i < token.NumPlaceholders(); i++) {
+                // Placeholders start one column after the previous token, and end with it
+                types_.push_back(static_cast<int8_t>(Token::Type::kPlaceholder));
+                offsets_.push_back(offsets_[index] + static_cast<uint32_t>(i) + 1);
+                lengths_.push_back(lengths_[index] - static_cast<uint32_t>(i) - 1);
+            }
+            while (classified + 1 < types_.size()) {
+                classified = classifier.Classify(*this, classified);
+            }
+            if (token.IsEof() || token.IsError()) {
+                break;
+            }
+        }
+    }
+
+    /// @returns the number of tokens, including placeholders and the final end of file or error
+    size_t Count() const { return types_.size(); }
+
+    /// @param index the token index
+    /// @returns the type of the token
+    Token::Type TypeAt(size_t index) const { return static_cast<Token::Type>(types_[index]); }
+
+    /// Sets the type of a token, as the parser does when it splits tokens
+    /// @param index the token index
+    /// @param type the new type
+    void SetTypeAt(size_t index, Token::Type type) { types_[index] = static_cast<int8_t>(type); }
+
+    /// @param index the token index
+    /// @returns the byte offset of the token in the file
+    uint32_t OffsetAt(size_t index) const { return offsets_[index]; }
+
+    /// @param index the token index
+    /// @returns the length of the token in bytes
+    uint32_t LengthAt(size_t index) const { return lengths_[index]; }
+
+    /// @param index the token index
+    /// @returns the text of the token in the file. For an identifier this is its name.
+    std::string_view TextAt(size_t index) const {
+        return std::string_view(file_->content.data).substr(offsets_[index], lengths_[index]);
+    }
+
+    /// @param index the token index
+    /// @returns the value of an integer literal token, or 0 for any other token
+    int64_t I64At(size_t index) const {
+        switch (TypeAt(index)) {
+            case Token::Type::kIntLiteral:
+            case Token::Type::kIntLiteral_I:
+            case Token::Type::kIntLiteral_U:
+                return static_cast<int64_t>(ValueAt(index));
+            default:
+                return 0;
+        }
+    }
+
+    /// @param index the token index
+    /// @returns the value of a float literal token, or 0 for any other token
+    double F64At(size_t index) const {
+        switch (TypeAt(index)) {
+            case Token::Type::kFloatLiteral:
+            case Token::Type::kFloatLiteral_F:
+            case Token::Type::kFloatLiteral_H: {
+                uint64_t bits = ValueAt(index);
+                double value = 0;
+                std::memcpy(&value, &bits, sizeof(value));
+                return value;
+            }
+            default:
+                return 0;
+        }
+    }
+
+    /// @param index the token index
+    /// @returns the message of an error token, or an empty string for any other token
+    std::string_view ErrorAt(size_t index) const {
+        if (TypeAt(index) != Token::Type::kError) {
+            return {};
+        }
+        return messages_[ValueAt(index)];
+    }
+
+    /// @param index the token index
+    /// @returns the source of the token, the same as Token::source() of the lexed token
+    Source SourceAt(size_t index) const {
+        Source::Range range{lines_.Locate(offsets_[index]),
+                            lines_.Locate(offsets_[index] + lengths_[index])};
+        return Source{range, file_};
+    }
+
+    /// @param index the token index
+    /// @returns the token as a Token, for code that takes one
+    Token TokenAt(size_t index) const {
+        Token::Type type = TypeAt(index);
+        Source source = SourceAt(index);
+        switch (type) {
+            case Token::Type::kIdentifier:
+                return Token(type, source, TextAt(index));
+            case Token::Type::kIntLiteral:
+            case Token::Type::kIntLiteral_I:
+            case Token::Type::kIntLiteral_U:
+                return Token(type, source, I64At(index));
+            case Token::Type::kFloatLiteral:
+            case Token::Type::kFloatLiteral_F:
+            case Token::Type::kFloatLiteral_H:
+                return Token(type, source, F64At(index));
+            case Token::Type::kError:
+                return Token(type, source, std::string(ErrorAt(index)));
+            default:
+                return Token(type, source);
+        }
+    }
+
+    /// @returns the number of heap bytes held by the table, not counting the line index
+    size_t MemoryUsage() const {
+        size_t bytes = types_.capacity() * sizeof(int8_t) +
+                       (offsets_.capacity() + lengths_.capacity() + valued_.capacity() +
+                        value_ids_.capacity()) *
+                           sizeof(uint32_t) +
+                       values_.capacity() * sizeof(uint64_t);
+        for (const std::string& message : messages_) {
+            bytes += sizeof(std::string) + message.capacity();
+        }
+        return bytes;
+    }
+
+  private:
+    static_assert(static_cast<int>(Token::Type::kError) >= INT8_MIN &&
+                      static_cast<int>(Token::Type::kWhile) <= INT8_MAX,
+                  "Token::Type no longer fits in a byte");
+
+    /// Appends `token`, converting its line and column to a byte offset
+    /// @returns the index of the token
+    size_t Append(const Token& token) {
+        size_t index = types_.size();
+        Source::Range range = token.source().range;
+        uint32_t begin = Offset(range.begin);
+        uint32_t end = std::max(begin, Offset(range.end));
+        types_.push_back(static_cast<int8_t>(token.type()));
+        offsets_.push_back(begin);
+        lengths_.push_back(end - begin);
+
+        switch (token.type()) {
+            case Token::Type::kIntLiteral:
+            case Token::Type::kIntLiteral_I:
+            case Token::Type::kIntLiteral_U:
+                AddValue(index, static_cast<uint64_t>(token.to_i64()));
+                break;
+            case Token::Type::kFloatLiteral:
+            case Token::Type::kFloatLiteral_F:
+            case Token::Type::kFloatLiteral_H: {
+                double value = token.to_f64();
+                uint64_t bits = 0;
+                std::memcpy(&bits, &value, sizeof(bits));
+                AddValue(index, bits);
+                break;
+            }
+            case Token::Type::kError:
+                valued_.push_back(static_cast<uint32_t>(index));
+                value_ids_.push_back(static_cast<uint32_t>(messages_.size()));
+                messages_.push_back(token.to_str());
+                break;
+            default:
+                break;
+        }
+        return index;
+    }
+
+    /// Records the literal value `bits` of token `index`, interned
+    void AddValue(size_t index, uint64_t bits) {
+        uint32_t id = interned_.GetOrAdd(bits, [&] {
+            values_.push_back(bits);
+            return static_cast<uint32_t>(values_.size() - 1);
+        });
+        valued_.push_back(static_cast<uint32_t>(index));
+        value_ids_.push_back(id);
+    }
+
+    /// @returns the side table entry of token `index`: the literal bits, or the message index
+    uint64_t ValueAt(size_t index) const {
+        auto it = std::lower_bound(valued_.begin(), valued_.end(), index);
+        size_t id = value_ids_[static_cast<size_t>(it - valued_.begin())];
+        return TypeAt(index) == Token::Type::kError ? id : values_[id];
+    }
+
+    /// @returns the byte offset of `location`, using the lines the file content was split into
+    uint32_t Offset(const Source::Location& location) const {
+        const auto& content = file_->content;
+        if (location.line == 0 || location.line > content.lines.size()) {
+            return static_cast<uint32_t>(content.data.size());
+        }
+        const std::string_view& line = content.lines[location.line - 1];
+        size_t offset = static_cast<size_t>(line.data() - content.data.data());
+        return static_cast<uint32_t>(offset + (location.column > 0 ? location.column - 1 : 0));
+    }
+
+    /// The source file
+    const Source::File* file_;
+    /// The type of each token
+    std::vector<int8_t> types_;
+    /// The byte offset of each token
+    std::vector<uint32_t> offsets_;
+    /// The byte length of each token
+    std::vector<uint32_t> lengths_;
+    /// The indices of the tokens with a side table entry, ascending
+    std::vector<uint32_t> valued_;
+    /// The side table entry of each token in #valued_: an index into #values_, or into #messages_
+    /// for error tokens
+    std::vector<uint32_t> value_ids_;
+    /// The distinct literal values, as the bits of an int64_t or a double
+    std::vector<uint64_t> values_;
+    /// The index of each value in #values_
+    Hashmap<uint64_t, uint32_t, 8> interned_;
+    /// The messages of error tokens
+    std::vector<std::string> messages_;
+    /// The lines of the file, split by the first SourceAt()
+    LineIndex lines_;
+};
+
+}  // namespace tint::wgsl::reader
+
+#endif  // SRC_TINT_LANG_WGSL_READER_PARSER_TOKEN_TABLE_H_
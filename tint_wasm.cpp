@@ -50,223 +50,3704 @@
 #define TINT_BUILD_SPV_WRITER 1
 
 #include "cmd/common/helper.h"
+#include "lang/spirv/writer/common/option_helpers.h"
+#include "lang/spirv/writer/raise/raise.h"
+#include "lang/wgsl/reader/parser/lexer.h"
+#include "lang/wgsl/reader/parser/parser.h"
+#include "lang/wgsl/resolver/resolve.h"
 #include "spirv-tools/libspirv.hpp"
+#include "spirv-tools/optimizer.hpp"
 #include "tint.h"
+#include "tint_wasm.h"
+#include "utils/diagnostic/line_index.h"
+#include "utils/math/crc32.h"
+#include "utils/math/hash.h"
 #include "utils/diagnostic/source.h"
+
+// Conversions compiled into the module, see the feature subsets in the
+// Makefile. Leaving one out lets the linker drop every part of libtint.a
+// and SPIRV-Tools that only it uses, and its exports report kUnsupported.
+//   TINT_WASM_WGSL_TO_SPIRV  WGSL reader, resolver and SPIR-V writer
+//   TINT_WASM_SPIRV_TO_WGSL  SPIR-V reader and WGSL writer
+//   TINT_WASM_SPIRV_TEXT     SPIRV-Tools assembler and disassembler
+#ifndef TINT_WASM_WGSL_TO_SPIRV
+#define TINT_WASM_WGSL_TO_SPIRV 1
+#endif
+#ifndef TINT_WASM_SPIRV_TO_WGSL
+#define TINT_WASM_SPIRV_TO_WGSL 1
+#endif
+#ifndef TINT_WASM_SPIRV_TEXT
+#define TINT_WASM_SPIRV_TEXT 1
+#endif
+
+#if TINT_BUILD_IR_BINARY
+#include "lang/core/ir/binary/decode.h"
+#include "lang/core/ir/binary/encode.h"
+#endif
+
+#include <algorithm>
+#include <atomic>
 #include <charconv>
+#include <chrono>
 #include <cstdint>
 #include <cstdio>
-#include <iostream>
+#include <cstring>
+#include <list>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <set>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
-enum class Format : uint8_t {
-  kUnknown,
-  kNone,
-  kSpirv,
-  kSpvAsm,
-  kWgsl,
-  kIr,
-  kIrBin
+#if TINT_WASM_THREADS
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <thread>
+#if defined(__EMSCRIPTEN__)
+#include <emscripten/threading.h>
+#endif
+#endif
+
+#if defined(__EMSCRIPTEN__)
+// JS reads the batch tables with fixed offsets, see tint_wasm.h
+static_assert(sizeof(TintBatchInput) == 12, "TintBatchInput layout changed");
+static_assert(sizeof(TintBatchResult) == 16, "TintBatchResult layout changed");
+static_assert(sizeof(TintOutput) == 20, "TintOutput layout changed");
+static_assert(sizeof(TintContextOptions) == 8,
+              "TintContextOptions layout changed");
+static_assert(sizeof(TintCacheStats) == 24, "TintCacheStats layout changed");
+static_assert(sizeof(TintPhaseStats) == 24, "TintPhaseStats layout changed");
+static_assert(sizeof(TintMemoryStats) == 52, "TintMemoryStats layout changed");
+static_assert(sizeof(TintError) == 12, "TintError layout changed");
+static_assert(sizeof(TintDiagnostic) == 24, "TintDiagnostic layout changed");
+static_assert(sizeof(TintOverride) == 16, "TintOverride layout changed");
+static_assert(sizeof(TintEntryPointResult) == 24,
+              "TintEntryPointResult layout changed");
+static_assert(sizeof(TintReflection) == 32, "TintReflection layout changed");
+static_assert(sizeof(TintOptimizerStats) == 20,
+              "TintOptimizerStats layout changed");
+static_assert(sizeof(TintReflectedEntryPoint) == 24,
+              "TintReflectedEntryPoint layout changed");
+static_assert(sizeof(TintReflectedBinding) == 20,
+              "TintReflectedBinding layout changed");
+static_assert(sizeof(TintReflectedOverride) == 8,
+              "TintReflectedOverride layout changed");
+static_assert(sizeof(TintReflectedVertexInput) == 12,
+              "TintReflectedVertexInput layout changed");
+#endif
+
+// One diagnostic of a conversion. Tint messages are kept styled, the way
+// Tint built them, and only flattened into `message` once they are read.
+struct DiagnosticRecord {
+  Severity severity = Severity::kError;
+  std::string file;
+  uint32_t line = 0;
+  uint32_t column = 0;
+  uint32_t length = 0;
+  tint::StyledText styled;
+  std::string message;
+  bool flattened = false;
+};
+
+// Reflection data of the program a conversion resolved, see
+// tint_context_set_reflection(). Strings are stored by value so that the
+// data can be copied in and out of the conversion cache; the tables handed
+// to JS are only laid out when they are asked for.
+struct Reflection {
+  struct EntryPoint {
+    std::string name;
+    uint8_t stage = 0;
+    bool has_workgroup_size = false;
+    uint32_t workgroup_size[3] = {0, 0, 0};
+    uint32_t workgroup_storage_size = 0;
+  };
+  struct Override {
+    std::string name;
+    uint16_t id = 0;
+    uint8_t type = 0;
+    uint8_t flags = 0;
+  };
+  struct VertexInput {
+    std::string name;
+    uint16_t entry_point = 0;
+    uint8_t component_type = 0;
+    uint8_t composition = 0;
+    uint32_t location = 0;
+  };
+
+  // False until a conversion with reflection enabled resolved a program
+  bool valid = false;
+  std::vector<EntryPoint> entry_points;
+  std::vector<TintReflectedBinding> bindings;
+  std::vector<Override> overrides;
+  std::vector<VertexInput> vertex_inputs;
+};
+
+// Output of a single conversion. Binary SPIR-V is stored in `spirv`,
+// every text format in `text`. Diagnostics are only kept as `records`;
+// their text is formatted by whichever export hands it out, so that the
+// same output can be served to contexts with diagnostic text on and off.
+struct Conversion {
+  std::string text;
+  std::vector<uint32_t> spirv;
+  std::vector<DiagnosticRecord> records;
+  Reflection reflection;
+};
+
+// Compile phases timed by the profiler. The names are what
+// tint_context_phase_stats() and the trace report.
+enum class Phase : uint8_t {
+  kConvert,
+  kCacheLookup,
+  kAssemble,
+  kDisassemble,
+  kWgslLex,
+  kWgslParse,
+  kWgslResolve,
+  kWgslToIr,
+  kWgslSpecialize,
+  kReflect,
+  kSpirvRead,
+  kSpirvReadIr,
+  kSpirvTransform,
+  kSpirvRaise,
+  kSpirvEmit,
+  kSpirvOptimize,
+  kWgslGenerate,
+  kWgslFromIr,
+  kIrEncode,
+  kIrDecode,
+  kCount
+};
+
+static const char *const kPhaseNames[] = {
+    "convert",
+    "cache.lookup",
+    "spirv-tools.assemble",
+    "spirv-tools.disassemble",
+    "wgsl.lex",
+    "wgsl.parse",
+    "wgsl.resolve",
+    "wgsl.to_ir",
+    "wgsl.specialize",
+    "inspector.reflect",
+    "spirv.read",
+    "spirv.read_ir",
+    "spirv.transform",
+    "spirv.raise",
+    "spirv.emit",
+    "spirv-tools.optimize",
+    "wgsl.generate",
+    "wgsl.from_ir",
+    "ir.encode",
+    "ir.decode",
+};
+static_assert(sizeof(kPhaseNames) / sizeof(kPhaseNames[0]) ==
+                  static_cast<size_t>(Phase::kCount),
+              "kPhaseNames is out of sync with Phase");
+
+// Per-context phase statistics and trace events, see
+// tint_context_set_profiling().
+class Profiler {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  Profiler() : tid_(next_tid_++) { Reset(); }
+
+  uint32_t flags = 0;
+
+  void Record(Phase phase, Clock::time_point start, Clock::time_point end) {
+    double us = std::chrono::duration<double, std::micro>(end - start).count();
+    TintPhaseStats &stats = stats_[static_cast<size_t>(phase)];
+    stats.calls++;
+    stats.total_us += us;
+    stats.max_us = std::max(stats.max_us, us);
+
+    if ((flags & kTintProfileTrace) && events_.size() < kMaxTraceEvents) {
+      double ts =
+          std::chrono::duration<double, std::micro>(start - Epoch()).count();
+      events_.push_back(TraceEvent{phase, ts, us});
+    }
+  }
+
+  void Reset() {
+    for (size_t i = 0; i < static_cast<size_t>(Phase::kCount); i++) {
+      stats_[i] = TintPhaseStats{kPhaseNames[i], 0, 0.0, 0.0};
+    }
+    events_.clear();
+  }
+
+  const TintPhaseStats *Stats() const { return stats_; }
+
+  // Returns: The recorded events as Chrome trace-event JSON
+  const char *Trace() {
+    trace_ = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    char event[160];
+    for (size_t i = 0; i < events_.size(); i++) {
+      snprintf(event, sizeof(event),
+               "%s{\"name\":\"%s\",\"cat\":\"tint\",\"ph\":\"X\",\"pid\":1,"
+               "\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+               i ? "," : "", kPhaseNames[static_cast<size_t>(events_[i].phase)],
+               tid_, events_[i].ts, events_[i].dur);
+      trace_ += event;
+    }
+    trace_ += "]}";
+    return trace_.c_str();
+  }
+
+private:
+  // Trace events past this many are dropped until the next reset
+  static constexpr size_t kMaxTraceEvents = 1 << 16;
+
+  struct TraceEvent {
+    Phase phase;
+    double ts;
+    double dur;
+  };
+
+  // Shared time origin, so traces of different contexts line up
+  static Clock::time_point Epoch() {
+    static const Clock::time_point epoch = Clock::now();
+    return epoch;
+  }
+
+  static inline std::atomic<uint32_t> next_tid_{1};
+
+  uint32_t tid_;
+  TintPhaseStats stats_[static_cast<size_t>(Phase::kCount)];
+  std::vector<TraceEvent> events_;
+  std::string trace_;
+};
+
+// Per-context compiler state. Everything a conversion reads or writes
+// lives in here, so independent contexts never step on each other and
+// can be driven from different threads at the same time.
+struct TintContext {
+  explicit TintContext(const TintContextOptions &options);
+
+  // Routes SPIRV-Tools messages into spirv_tools_records
+  spvtools::MessageConsumer SpirvToolsConsumer();
+
+  // The options the context was created with
+  TintContextOptions options;
+
+  // Phase timings, only collected while profiling is enabled
+  Profiler profiler;
+
+  // Memory used by the Tint structures of the last conversion
+  TintMemoryStats memory = {};
+
+  // SPIRV-Tools, created by the first conversion that needs it, plus the
+  // messages it reported for the current conversion
+  spvtools::SpirvTools &GetSpirvTools();
+  std::unique_ptr<spvtools::SpirvTools> spirv_tools;
+  std::vector<DiagnosticRecord> spirv_tools_records;
+
+  // Optimizer run on every SPIR-V module Tint generates. It is built once
+  // by tint_context_set_optimizer() and reused, along with its pass list,
+  // by every conversion until the mode changes. `optimizer_key` tells the
+  // pass lists apart in cache keys, 0 while the optimizer is off.
+  OptimizeMode optimize_mode = OptimizeMode::kNone;
+  std::string optimizer_flags;
+  uint64_t optimizer_key = 0;
+  std::unique_ptr<spvtools::Optimizer> optimizer;
+  std::unique_ptr<spvtools::OptimizerOptions> optimizer_options;
+  TintOptimizerStats optimizer_stats = {};
+
+  // Whether failing conversions format their diagnostics as text
+  bool diagnostic_text = true;
+
+  // Cancellation flag of the asynchronous request the context is running,
+  // checked between the stages of a conversion. nullptr otherwise.
+  const std::atomic<bool> *cancel = nullptr;
+
+  // Records of the last tint_convert() or single shader export, plus the
+  // tables handed out by tint_context_diagnostics() and friends
+  std::vector<DiagnosticRecord> last_records;
+  std::vector<TintDiagnostic> diagnostic_table;
+  std::string diagnostic_json;
+
+  // Whether conversions reflect the program they resolve, the reflection
+  // of the last tint_convert() or single shader export, and the tables
+  // handed out by tint_context_reflection()
+  bool reflect = false;
+  Reflection last_reflection;
+  TintReflection reflection_table = {};
+  std::vector<TintReflectedEntryPoint> reflected_entry_points;
+  std::vector<TintReflectedOverride> reflected_overrides;
+  std::vector<TintReflectedVertexInput> reflected_vertex_inputs;
+
+  // Tint
+  tint::spirv::reader::Options spv_reader_options;
+  tint::spirv::writer::Options spv_writer_options;
+  tint::wgsl::writer::Options wgsl_writer_options;
+
+  // Output storage of the single shader exports
+  std::string wgsl_gen;
+  std::string spv_asm_gen;
+  std::vector<uint32_t> spv_bin_gen;
+
+  // Outcome of the last single shader export, see tint_last_error(). Its
+  // diagnostics are formatted from `last_records` when it is first read,
+  // or before a later conversion replaces them.
+  TintError last_error = {};
+  std::string last_error_diagnostics;
+  bool last_error_unformatted = false;
+
+  // Outputs handed off to the caller by tint_convert(), keyed by the data
+  // pointer the caller received, until tint_output_free() releases them.
+  std::unordered_map<const void *, std::unique_ptr<Conversion>>
+      owned_outputs;
+
+  // Scratch conversion for tint_convert() calls that write into a caller
+  // provided buffer, along with the diagnostics of the last call.
+  Conversion convert_scratch;
+  std::string convert_diagnostics;
+
+  // Storage backing the tables returned by tint_batch_compile(). The
+  // vectors are reused between batches so their capacity carries over.
+  std::vector<TintBatchResult> batch_results;
+  std::vector<Conversion> batch_outputs;
+  std::string batch_diagnostics;
+};
+
+TintContext::TintContext(const TintContextOptions &options)
+    : options(options) {
+  spv_reader_options.allow_non_uniform_derivatives =
+      options.allow_non_uniform_derivatives != 0;
+  spv_writer_options.disable_robustness = options.disable_robustness != 0;
+  spv_writer_options.disable_workgroup_init =
+      options.disable_workgroup_init != 0;
+}
+
+spvtools::SpirvTools &TintContext::GetSpirvTools() {
+  if (!spirv_tools) {
+    spirv_tools = std::make_unique<spvtools::SpirvTools>(
+        static_cast<spv_target_env>(options.spirv_env));
+    spirv_tools->SetMessageConsumer(SpirvToolsConsumer());
+  }
+  return *spirv_tools;
+}
+
+// Returns: true if the request running on `ctx` was cancelled, in which
+//          case the conversion stops before its next stage
+static bool Cancelled(const TintContext &ctx) {
+  return ctx.cancel && ctx.cancel->load(std::memory_order_relaxed);
+}
+
+spvtools::MessageConsumer TintContext::SpirvToolsConsumer() {
+  return [this](spv_message_level_t level, const char *,
+                const spv_position_t &position, const char *message) {
+    DiagnosticRecord record;
+    record.severity = level <= SPV_MSG_ERROR     ? Severity::kError
+                      : level == SPV_MSG_WARNING ? Severity::kWarning
+                                                 : Severity::kNote;
+    record.line = static_cast<uint32_t>(position.line + 1);
+    record.column = static_cast<uint32_t>(position.column + 1);
+    record.message = message;
+    record.flattened = true;
+    spirv_tools_records.push_back(std::move(record));
+  };
+}
+
+// The single shader exports predate contexts, so they keep sharing the
+// global context below.
+static const TintContextOptions kDefaultContextOptions = {
+    SPV_ENV_UNIVERSAL_1_3, 0, 0, 0, 0};
+
+// The default context is only created by the first export that uses it,
+// so instantiating the module doesn't pay for it.
+static TintContext &DefaultContext() {
+  static TintContext context(kDefaultContextOptions);
+  return context;
+}
+
+// Times one phase of a conversion on `ctx`, from construction until Stop()
+// or destruction, whichever comes first. Does nothing unless profiling is
+// enabled on the context.
+class PhaseTimer {
+public:
+  PhaseTimer(TintContext &ctx, Phase phase)
+      : profiler_(ctx.profiler.flags ? &ctx.profiler : nullptr),
+        phase_(phase) {
+    if (profiler_) {
+      start_ = Profiler::Clock::now();
+    }
+  }
+
+  ~PhaseTimer() { Stop(); }
+
+  // Returns: The time recorded, zero if not profiling or already stopped
+  Profiler::Clock::duration Stop() {
+    if (!profiler_) {
+      return {};
+    }
+    auto end = std::max(start_, Profiler::Clock::now() - excluded_);
+    profiler_->Record(phase_, start_, end);
+    profiler_ = nullptr;
+    return end - start_;
+  }
+
+  // Leaves `time` that another phase accounts for out of this one
+  void Exclude(Profiler::Clock::duration time) { excluded_ += time; }
+
+private:
+  Profiler *profiler_;
+  Phase phase_;
+  Profiler::Clock::time_point start_;
+  Profiler::Clock::duration excluded_{};
+};
+
+// 128-bit MurmurHash3 (x64 variant) of `size` bytes at `data`.
+static void Murmur3(const void *data, size_t size, uint64_t seed,
+                    uint64_t out[2]) {
+  auto rotl = [](uint64_t x, int r) { return (x << r) | (x >> (64 - r)); };
+  auto fmix = [](uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdull;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ull;
+    k ^= k >> 33;
+    return k;
+  };
+  const uint64_t c1 = 0x87c37b91114253d5ull;
+  const uint64_t c2 = 0x4cf5ad432745937full;
+
+  auto *bytes = static_cast<const uint8_t *>(data);
+  const size_t blocks = size / 16;
+  uint64_t h1 = seed;
+  uint64_t h2 = seed;
+
+  for (size_t i = 0; i < blocks; i++) {
+    uint64_t k1, k2;
+    std::memcpy(&k1, bytes + i * 16, 8);
+    std::memcpy(&k2, bytes + i * 16 + 8, 8);
+
+    k1 *= c1;
+    k1 = rotl(k1, 31);
+    k1 *= c2;
+    h1 ^= k1;
+    h1 = rotl(h1, 27);
+    h1 += h2;
+    h1 = h1 * 5 + 0x52dce729;
+
+    k2 *= c2;
+    k2 = rotl(k2, 33);
+    k2 *= c1;
+    h2 ^= k2;
+    h2 = rotl(h2, 31);
+    h2 += h1;
+    h2 = h2 * 5 + 0x38495ab5;
+  }
+
+  const uint8_t *tail = bytes + blocks * 16;
+  uint64_t k1 = 0;
+  uint64_t k2 = 0;
+  for (size_t i = size & 15; i > 8; i--) {
+    k2 |= uint64_t(tail[i - 1]) << ((i - 9) * 8);
+  }
+  for (size_t i = std::min<size_t>(size & 15, 8); i > 0; i--) {
+    k1 |= uint64_t(tail[i - 1]) << ((i - 1) * 8);
+  }
+  if (k2) {
+    k2 *= c2;
+    k2 = rotl(k2, 33);
+    k2 *= c1;
+    h2 ^= k2;
+  }
+  if (k1) {
+    k1 *= c1;
+    k1 = rotl(k1, 31);
+    k1 *= c2;
+    h1 ^= k1;
+  }
+
+  h1 ^= size;
+  h2 ^= size;
+  h1 += h2;
+  h2 += h1;
+  h1 = fmix(h1);
+  h2 = fmix(h2);
+  h1 += h2;
+  h2 += h1;
+  out[0] = h1;
+  out[1] = h2;
+}
+
+// Builds the optimizer of `ctx` for `mode`. `flags` is a whitespace
+// separated list of spirv-opt flags, only used by OptimizeMode::kCustom.
+// Returns: false if the mode or one of the flags is not valid, in which
+//          case the optimizer is left off
+static bool SetOptimizer(TintContext &ctx, OptimizeMode mode,
+                         const std::string &flags) {
+  ctx.optimize_mode = OptimizeMode::kNone;
+  ctx.optimizer_flags.clear();
+  ctx.optimizer_key = 0;
+  ctx.optimizer.reset();
+  if (mode == OptimizeMode::kNone) {
+    return true;
+  }
+
+#if TINT_WASM_WGSL_TO_SPIRV
+  auto optimizer = std::make_unique<spvtools::Optimizer>(
+      static_cast<spv_target_env>(ctx.options.spirv_env));
+  optimizer->SetMessageConsumer(ctx.SpirvToolsConsumer());
+  switch (mode) {
+  case OptimizeMode::kPerformance:
+    optimizer->RegisterPerformancePasses();
+    break;
+  case OptimizeMode::kSize:
+    optimizer->RegisterSizePasses();
+    break;
+  case OptimizeMode::kCustom: {
+    std::vector<std::string> list;
+    size_t start = flags.find_first_not_of(" \t\n");
+    while (start != std::string::npos) {
+      size_t end = flags.find_first_of(" \t\n", start);
+      list.push_back(flags.substr(start, end - start));
+      start = flags.find_first_not_of(" \t\n", end);
+    }
+    if (list.empty() || !optimizer->RegisterPassesFromFlags(list)) {
+      return false;
+    }
+    break;
+  }
+  default:
+    return false;
+  }
+
+  if (!ctx.optimizer_options) {
+    // Tint only emits valid SPIR-V, so skip the validator, and keep the
+    // bindings the pipeline layout refers to
+    ctx.optimizer_options = std::make_unique<spvtools::OptimizerOptions>();
+    ctx.optimizer_options->set_run_validator(false);
+    ctx.optimizer_options->set_preserve_bindings(true);
+  }
+
+  ctx.optimize_mode = mode;
+  ctx.optimizer_flags = mode == OptimizeMode::kCustom ? flags : "";
+  uint64_t key[2];
+  std::string id = std::to_string(static_cast<uint32_t>(mode)) + ":" +
+                   ctx.optimizer_flags;
+  Murmur3(id.data(), id.size(), 0, key);
+  ctx.optimizer_key = key[0] | 1;
+  ctx.optimizer = std::move(optimizer);
+  return true;
+#else
+  // Nothing in this build generates SPIR-V to optimize
+  (void)flags;
+  return false;
+#endif
+}
+
+// Adds `stats` to one row of the memory statistics of a context.
+static void AddAllocatorStats(TintMemoryStats &memory, TintAllocatorStats &row,
+                              const tint::AllocatorStats &stats) {
+  row.objects += static_cast<uint32_t>(stats.objects);
+  row.blocks += static_cast<uint32_t>(stats.blocks);
+  row.bytes += static_cast<uint32_t>(stats.bytes);
+  memory.peak_bytes += static_cast<uint32_t>(stats.bytes);
+}
+
+// Records the memory held by a program in the statistics of `ctx`.
+static void AccountProgram(TintContext &ctx, const tint::Program &program) {
+  TintMemoryStats &memory = ctx.memory;
+  tint::AllocatorStats nodes = program.ASTNodes().Stats();
+  nodes += program.SemNodes().Stats();
+  nodes += program.Symbols().Stats();
+  AddAllocatorStats(memory, memory.program, nodes);
+  AddAllocatorStats(memory, memory.types, program.Types().Stats());
+  AddAllocatorStats(memory, memory.constants, program.Constants().Stats());
+}
+
+// Records the memory held by an IR module in the statistics of `ctx`.
+static void AccountIr(TintContext &ctx, const tint::core::ir::Module &ir) {
+  TintMemoryStats &memory = ctx.memory;
+  tint::AllocatorStats nodes = ir.blocks.Stats();
+  nodes += ir.allocators.instructions.Stats();
+  nodes += ir.allocators.values.Stats();
+  nodes += ir.symbols.Stats();
+  AddAllocatorStats(memory, memory.ir, nodes);
+  AddAllocatorStats(memory, memory.types, ir.Types().Stats());
+  AddAllocatorStats(memory, memory.constants, ir.constant_values.Stats());
+}
+
+// Stores the diagnostics Tint reported for a conversion in `out`. The
+// records are taken while the source files they point into are still
+// alive; the text is only formatted when an export hands it out.
+static void CaptureDiagnostics(const tint::diag::List &list, Conversion &out) {
+  for (const tint::diag::Diagnostic &diagnostic : list) {
+    const tint::Source &source = diagnostic.source;
+    DiagnosticRecord record;
+    record.severity = static_cast<Severity>(diagnostic.severity);
+    record.line = source.range.begin.line;
+    record.column = source.range.begin.column;
+    if (source.file) {
+      record.file = source.file->path;
+      record.length =
+          static_cast<uint32_t>(source.range.Length(source.file->content));
+    } else if (source.range.end.line == source.range.begin.line &&
+               source.range.end.column > source.range.begin.column) {
+      record.length = source.range.end.column - source.range.begin.column;
+    }
+    record.styled = diagnostic.message;
+    out.records.push_back(std::move(record));
+  }
+}
+
+// Hands the messages SPIRV-Tools reported for a failed call over to `out`.
+static void CaptureSpirvToolsDiagnostics(TintContext &ctx, Conversion &out) {
+  out.records = std::move(ctx.spirv_tools_records);
+}
+
+static const char *const kSeverityNames[] = {"note", "warning", "error"};
+
+// Flattens the styled messages of `records` that were not read before.
+static void FlattenDiagnostics(std::vector<DiagnosticRecord> &records) {
+  for (DiagnosticRecord &record : records) {
+    if (!record.flattened) {
+      record.message = record.styled.Plain();
+      record.flattened = true;
+    }
+  }
+}
+
+// Formats `records` as text, one "file:line:column severity: message" line
+// each. The file is left out for records without one, like the messages
+// of SPIRV-Tools, and the position for records without a line.
+// Returns: The text, empty while `ctx` has diagnostic text off
+static std::string DiagnosticText(const TintContext &ctx,
+                                  std::vector<DiagnosticRecord> &records) {
+  std::string text;
+  if (!ctx.diagnostic_text) {
+    return text;
+  }
+  FlattenDiagnostics(records);
+  for (const DiagnosticRecord &record : records) {
+    if (!record.file.empty()) {
+      text += record.file;
+      text += ':';
+    }
+    if (record.line != 0) {
+      text += std::to_string(record.line);
+      text += ':';
+      text += std::to_string(record.column);
+      text += ' ';
+    } else if (!record.file.empty()) {
+      text += ' ';
+    }
+    text += kSeverityNames[static_cast<size_t>(record.severity)];
+    text += ": ";
+    text += record.message;
+    text += '\n';
+  }
+  return text;
+}
+
+// Appends the text of `records` to a diagnostics blob, NUL terminated.
+// Returns: Offset of the text in `blob`, kTintNoDiagnostics if there is none
+static uint32_t AppendDiagnosticText(const TintContext &ctx,
+                                     std::vector<DiagnosticRecord> &records,
+                                     std::string &blob) {
+  std::string text = DiagnosticText(ctx, records);
+  if (text.empty()) {
+    return kTintNoDiagnostics;
+  }
+  uint32_t offset = static_cast<uint32_t>(blob.size());
+  blob += text;
+  blob += '\0';
+  return offset;
+}
+
+static Status Disassemble(TintContext &ctx, const uint32_t *spirv,
+                          size_t size, Conversion &out) {
+#if TINT_WASM_SPIRV_TEXT
+  if (Cancelled(ctx)) {
+    return Status::kCancelled;
+  }
+  PhaseTimer timer(ctx, Phase::kDisassemble);
+  ctx.spirv_tools_records.clear();
+  if (!ctx.GetSpirvTools().Disassemble(
+          spirv, size, &out.text,
+          SPV_BINARY_TO_TEXT_OPTION_INDENT |
+              SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES)) {
+    CaptureSpirvToolsDiagnostics(ctx, out);
+    return Status::kGenerateFailed;
+  }
+  return Status::kSuccess;
+#else
+  (void)ctx;
+  (void)spirv;
+  (void)size;
+  (void)out;
+  return Status::kUnsupported;
+#endif
+}
+
+static Status Assemble(TintContext &ctx, const char *spv_asm, size_t size,
+                       std::vector<uint32_t> &binary, Conversion &out) {
+#if TINT_WASM_SPIRV_TEXT
+  PhaseTimer timer(ctx, Phase::kAssemble);
+  ctx.spirv_tools_records.clear();
+  if (!ctx.GetSpirvTools().Assemble(
+          spv_asm, size, &binary,
+          SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS)) {
+    CaptureSpirvToolsDiagnostics(ctx, out);
+    return Status::kParseFailed;
+  }
+  return Status::kSuccess;
+#else
+  (void)ctx;
+  (void)spv_asm;
+  (void)size;
+  (void)binary;
+  (void)out;
+  return Status::kUnsupported;
+#endif
+}
+
+#if TINT_WASM_WGSL_TO_SPIRV
+
+// Runs the optimizer of the context over SPIR-V that Tint just generated,
+// replacing `spirv` with the optimized module. Does nothing while the
+// optimizer is off.
+static Status Optimize(TintContext &ctx, std::vector<uint32_t> &spirv,
+                       Conversion &out) {
+  if (!ctx.optimizer) {
+    return Status::kSuccess;
+  }
+  if (Cancelled(ctx)) {
+    return Status::kCancelled;
+  }
+  PhaseTimer timer(ctx, Phase::kSpirvOptimize);
+  ctx.spirv_tools_records.clear();
+  std::vector<uint32_t> optimized;
+  if (!ctx.optimizer->Run(spirv.data(), spirv.size(), &optimized,
+                          *ctx.optimizer_options)) {
+    CaptureSpirvToolsDiagnostics(ctx, out);
+    return Status::kGenerateFailed;
+  }
+
+  TintOptimizerStats &stats = ctx.optimizer_stats;
+  stats.runs++;
+  stats.last_words_in = static_cast<uint32_t>(spirv.size());
+  stats.last_words_out = static_cast<uint32_t>(optimized.size());
+  stats.total_words_in += stats.last_words_in;
+  stats.total_words_out += stats.last_words_out;
+  spirv = std::move(optimized);
+  return Status::kSuccess;
+}
+
+#endif // TINT_WASM_WGSL_TO_SPIRV
+
+// Reflects the entry points, resource bindings, overrides and vertex
+// inputs of a program that was just resolved into `out`, so JS doesn't
+// have to parse the output again to get at them. Does nothing unless the
+// context has reflection enabled.
+static void Reflect(TintContext &ctx, const tint::Program &program,
+                    Conversion &out) {
+  if (!ctx.reflect) {
+    return;
+  }
+  PhaseTimer timer(ctx, Phase::kReflect);
+  tint::inspector::Inspector inspector(program);
+  Reflection &reflection = out.reflection;
+  reflection = Reflection{};
+  reflection.valid = true;
+
+  auto entry_points = inspector.GetEntryPoints();
+  for (size_t i = 0; i < entry_points.size(); i++) {
+    const tint::inspector::EntryPoint &entry_point = entry_points[i];
+    Reflection::EntryPoint reflected;
+    reflected.name = entry_point.name;
+    reflected.stage = static_cast<uint8_t>(entry_point.stage);
+    if (entry_point.workgroup_size) {
+      reflected.has_workgroup_size = true;
+      reflected.workgroup_size[0] = entry_point.workgroup_size->x;
+      reflected.workgroup_size[1] = entry_point.workgroup_size->y;
+      reflected.workgroup_size[2] = entry_point.workgroup_size->z;
+    }
+    reflected.workgroup_storage_size = entry_point.workgroup_storage_size;
+    reflection.entry_points.push_back(std::move(reflected));
+
+    for (const auto &resource : inspector.GetResourceBindings(entry_point.name)) {
+      TintReflectedBinding binding = {};
+      binding.entry_point = static_cast<uint16_t>(i);
+      binding.resource_type = static_cast<uint8_t>(resource.resource_type);
+      binding.dimension = static_cast<uint8_t>(resource.dim);
+      binding.group = resource.bind_group;
+      binding.binding = resource.binding;
+      binding.sampled_kind = static_cast<uint8_t>(resource.sampled_kind);
+      binding.texel_format = static_cast<uint8_t>(resource.image_format);
+      binding.size = static_cast<uint32_t>(resource.size);
+      reflection.bindings.push_back(binding);
+    }
+
+    if (entry_point.stage == tint::inspector::PipelineStage::kVertex) {
+      for (const auto &input : entry_point.input_variables) {
+        if (!input.attributes.location) {
+          continue;
+        }
+        Reflection::VertexInput reflected_input;
+        reflected_input.name = input.name;
+        reflected_input.entry_point = static_cast<uint16_t>(i);
+        reflected_input.component_type =
+            static_cast<uint8_t>(input.component_type);
+        reflected_input.composition =
+            static_cast<uint8_t>(input.composition_type);
+        reflected_input.location = *input.attributes.location;
+        reflection.vertex_inputs.push_back(std::move(reflected_input));
+      }
+    }
+
+    // Entry points report the overrides they use, list each one once
+    for (const auto &override : entry_point.overrides) {
+      bool seen = false;
+      for (const auto &reflected_override : reflection.overrides) {
+        seen |= reflected_override.id == override.id.value;
+      }
+      if (seen) {
+        continue;
+      }
+      Reflection::Override reflected_override;
+      reflected_override.name = override.name;
+      reflected_override.id = override.id.value;
+      reflected_override.type = static_cast<uint8_t>(override.type);
+      reflected_override.flags =
+          (override.is_initialized ? kTintOverrideInitialized : 0) |
+          (override.is_id_specified ? kTintOverrideIdSpecified : 0);
+      reflection.overrides.push_back(std::move(reflected_override));
+    }
+  }
+}
+
+#if TINT_WASM_WGSL_TO_SPIRV
+
+// ast_printer.h and printer.h pull in SPIRV-Headers, which are not part of
+// this tree, so the two writer entry points timed on their own are
+// declared here the way those headers declare them.
+namespace tint::spirv::writer {
+struct SanitizedResult {
+  Program program;
+};
+SanitizedResult Sanitize(const Program &program, const Options &options);
+Result<std::vector<uint32_t>> Print(core::ir::Module &module,
+                                    bool zero_init_workgroup_memory);
+} // namespace tint::spirv::writer
+
+// Same as tint::spirv::writer::Generate() for an AST program. Generate()
+// runs the AST transforms and the printer in one go, so to time the
+// transforms on their own the profiler runs them over the program once
+// more, and takes that time off the printer. The split between the two is
+// therefore an estimate.
+static Status GenerateSpirv(TintContext &ctx, const tint::Program &program,
+                            std::vector<uint32_t> &spirv, Conversion &out) {
+  Profiler::Clock::duration transform_time{};
+  if (ctx.profiler.flags) {
+    PhaseTimer transform(ctx, Phase::kSpirvTransform);
+    tint::spirv::writer::Sanitize(program, ctx.spv_writer_options);
+    transform_time = transform.Stop();
+  }
+
+  PhaseTimer emit(ctx, Phase::kSpirvEmit);
+  emit.Exclude(transform_time);
+  auto result = tint::spirv::writer::Generate(program, ctx.spv_writer_options);
+  emit.Stop();
+  if (result != tint::Success) {
+    CaptureDiagnostics(result.Failure().reason, out);
+    return Status::kGenerateFailed;
+  }
+  spirv = std::move(result->spirv);
+  return Status::kSuccess;
+}
+
+// Same as tint::spirv::writer::Generate() for an IR module, split up so
+// that the raise passes and the printer are timed separately. Raising
+// rewrites `ir` into the SPIR-V dialect.
+static Status GenerateSpirv(TintContext &ctx, tint::core::ir::Module &ir,
+                            std::vector<uint32_t> &spirv, Conversion &out) {
+  const auto &options = ctx.spv_writer_options;
+  if (auto valid = tint::spirv::writer::ValidateBindingOptions(options);
+      valid != tint::Success) {
+    CaptureDiagnostics(valid.Failure().reason, out);
+    return Status::kGenerateFailed;
+  }
+
+  PhaseTimer raise(ctx, Phase::kSpirvRaise);
+  auto raised = tint::spirv::writer::Raise(ir, options);
+  raise.Stop();
+  if (raised != tint::Success) {
+    CaptureDiagnostics(raised.Failure().reason, out);
+    return Status::kGenerateFailed;
+  }
+
+  // Generate() zero-initializes workgroup memory the same way
+  bool zero_init_workgroup_memory =
+      !options.disable_workgroup_init &&
+      options.use_zero_initialize_workgroup_memory_extension;
+  PhaseTimer emit(ctx, Phase::kSpirvEmit);
+  auto printed = tint::spirv::writer::Print(ir, zero_init_workgroup_memory);
+  emit.Stop();
+  if (printed != tint::Success) {
+    CaptureDiagnostics(printed.Failure().reason, out);
+    return Status::kGenerateFailed;
+  }
+  spirv = std::move(printed.Get());
+  return Status::kSuccess;
+}
+
+#endif // TINT_WASM_WGSL_TO_SPIRV
+
+// Generates `to` from a resolved AST program with the AST writers.
+static Status ProgramToOutput(TintContext &ctx, const tint::Program &program,
+                              Format to, Conversion &out) {
+  if (Cancelled(ctx)) {
+    return Status::kCancelled;
+  }
+  switch (to) {
+#if TINT_WASM_WGSL_TO_SPIRV
+  case Format::kSpirv:
+  case Format::kSpvAsm: {
+    std::vector<uint32_t> spirv;
+    Status status = GenerateSpirv(ctx, program, spirv, out);
+    if (status != Status::kSuccess) {
+      return status;
+    }
+    status = Optimize(ctx, spirv, out);
+    if (status != Status::kSuccess) {
+      return status;
+    }
+    if (to == Format::kSpvAsm) {
+      return Disassemble(ctx, spirv.data(), spirv.size(), out);
+    }
+    out.spirv = std::move(spirv);
+    return Status::kSuccess;
+  }
+#endif
+#if TINT_WASM_SPIRV_TO_WGSL
+  case Format::kWgsl: {
+    PhaseTimer generate(ctx, Phase::kWgslGenerate);
+    auto result =
+        tint::wgsl::writer::Generate(program, ctx.wgsl_writer_options);
+    generate.Stop();
+    if (result != tint::Success) {
+      CaptureDiagnostics(result.Failure().reason, out);
+      return Status::kGenerateFailed;
+    }
+    out.text = std::move(result->wgsl);
+    return Status::kSuccess;
+  }
+#endif
+  default:
+    return Status::kUnsupported;
+  }
+}
+
+static Status SpirvToWgsl(TintContext &ctx, const std::vector<uint32_t> &spirv,
+                          Conversion &out) {
+#if TINT_WASM_SPIRV_TO_WGSL
+  PhaseTimer read(ctx, Phase::kSpirvRead);
+  auto program = tint::spirv::reader::Read(spirv, ctx.spv_reader_options);
+  read.Stop();
+  AccountProgram(ctx, program);
+  if (!program.IsValid()) {
+    CaptureDiagnostics(program.Diagnostics(), out);
+    return Status::kParseFailed;
+  }
+
+  Reflect(ctx, program, out);
+  return ProgramToOutput(ctx, program, Format::kWgsl, out);
+#else
+  (void)ctx;
+  (void)spirv;
+  (void)out;
+  return Status::kUnsupported;
+#endif
+}
+
+#if TINT_WASM_WGSL_TO_SPIRV
+
+// Same as tint::wgsl::reader::Parse(), split up so that parsing and
+// resolving are timed separately. The parser lexes as it goes, so to time
+// the lexer on its own the profiler runs it over the source once more, and
+// takes that time off the parse. The split between the two is therefore an
+// estimate. `parsed`, if set, tells whether the diagnostics of an invalid
+// program came from the parser or the resolver.
+static tint::Program ParseWgsl(TintContext &ctx,
+                               const tint::Source::File &source,
+                               bool *parsed = nullptr) {
+  Profiler::Clock::duration lex_time{};
+  if (ctx.profiler.flags) {
+    PhaseTimer lex(ctx, Phase::kWgslLex);
+    tint::wgsl::reader::Lexer(&source).Lex();
+    lex_time = lex.Stop();
+  }
+
+  tint::wgsl::reader::Parser parser(&source);
+  PhaseTimer parse(ctx, Phase::kWgslParse);
+  parse.Exclude(lex_time);
+  bool ok = parser.Parse();
+  parse.Stop();
+  if (parsed) {
+    *parsed = ok;
+  }
+
+  PhaseTimer resolve(ctx, Phase::kWgslResolve);
+  return tint::resolver::Resolve(
+      parser.builder(), tint::wgsl::reader::Options{}.allowed_features);
+}
+
+static Status WgslToSpirv(TintContext &ctx, const char *wgsl, size_t size,
+                          Conversion &out) {
+  tint::Source::File source("input.wgsl", std::string_view(wgsl, size));
+
+  auto program = ParseWgsl(ctx, source);
+  AccountProgram(ctx, program);
+  if (!program.IsValid()) {
+    CaptureDiagnostics(program.Diagnostics(), out);
+    return Status::kParseFailed;
+  }
+
+  Reflect(ctx, program, out);
+  return ProgramToOutput(ctx, program, Format::kSpirv, out);
+}
+
+#endif // TINT_WASM_WGSL_TO_SPIRV
+
+#if TINT_BUILD_IR_BINARY
+
+// Identifies the build that encoded an IR blob. The Makefile passes a
+// checksum of libtint.a, since the encoding changes along with Tint.
+#ifndef TINT_WASM_IR_FINGERPRINT
+#define TINT_WASM_IR_FINGERPRINT __DATE__ " " __TIME__
+#endif
+
+// Header in front of every encoded IR blob, so that blobs written by a
+// different build of the module are rejected without decoding them. The
+// payload size and CRC32 catch blobs that were truncated or corrupted in
+// storage, which the protobuf decoder can't be trusted to reject.
+struct IrBlobHeader {
+  char magic[4];
+  uint32_t version;
+  uint64_t fingerprint;
+  uint32_t payload_size;
+  uint32_t payload_crc;
+};
+
+static constexpr char kIrBlobMagic[4] = {'T', 'I', 'R', 'B'};
+static constexpr uint32_t kIrBlobVersion = 2;
+
+static uint64_t IrBlobFingerprint() {
+  static const uint64_t fingerprint = [] {
+    const char *build = TINT_WASM_IR_FINGERPRINT;
+    uint64_t hash[2];
+    Murmur3(build, strlen(build), 0, hash);
+    return hash[0];
+  }();
+  return fingerprint;
+}
+
+static Status EncodeIr(TintContext &ctx, const tint::core::ir::Module &ir,
+                       Conversion &out) {
+  PhaseTimer timer(ctx, Phase::kIrEncode);
+  auto encoded = tint::core::ir::binary::Encode(ir);
+  if (encoded != tint::Success) {
+    CaptureDiagnostics(encoded.Failure().reason, out);
+    return Status::kGenerateFailed;
+  }
+
+  IrBlobHeader header;
+  std::memcpy(header.magic, kIrBlobMagic, sizeof(header.magic));
+  header.version = kIrBlobVersion;
+  header.fingerprint = IrBlobFingerprint();
+
+  auto payload = encoded->Slice();
+  header.payload_size = static_cast<uint32_t>(payload.len);
+  header.payload_crc = tint::CRC32(payload.data, payload.len);
+  out.text.resize(sizeof(header) + payload.len);
+  std::memcpy(out.text.data(), &header, sizeof(header));
+  std::memcpy(out.text.data() + sizeof(header), payload.data, payload.len);
+  return Status::kSuccess;
+}
+
+#endif // TINT_BUILD_IR_BINARY
+
+// IrToOutput(), minus the memory accounting.
+static Status GenerateFromIr(TintContext &ctx, tint::core::ir::Module &ir,
+                             Format to, Conversion &out) {
+  if (Cancelled(ctx)) {
+    return Status::kCancelled;
+  }
+  switch (to) {
+#if TINT_WASM_WGSL_TO_SPIRV
+  case Format::kSpirv:
+  case Format::kSpvAsm: {
+    std::vector<uint32_t> spirv;
+    Status status = GenerateSpirv(ctx, ir, spirv, out);
+    if (status != Status::kSuccess) {
+      return status;
+    }
+    status = Optimize(ctx, spirv, out);
+    if (status != Status::kSuccess) {
+      return status;
+    }
+    if (to == Format::kSpvAsm) {
+      return Disassemble(ctx, spirv.data(), spirv.size(), out);
+    }
+    out.spirv = std::move(spirv);
+    return Status::kSuccess;
+  }
+#endif
+#if TINT_WASM_SPIRV_TO_WGSL
+  case Format::kWgsl: {
+    tint::wgsl::writer::ProgramOptions options;
+    options.allow_non_uniform_derivatives =
+        ctx.spv_reader_options.allow_non_uniform_derivatives;
+    options.allowed_features = ctx.spv_reader_options.allowed_features;
+    PhaseTimer generate(ctx, Phase::kWgslFromIr);
+    auto result = tint::wgsl::writer::WgslFromIR(ir, options);
+    generate.Stop();
+    if (result != tint::Success) {
+      CaptureDiagnostics(result.Failure().reason, out);
+      return Status::kGenerateFailed;
+    }
+    out.text = std::move(result->wgsl);
+    return Status::kSuccess;
+  }
+#endif
+#if TINT_BUILD_IR_BINARY
+  case Format::kIrBin:
+    return EncodeIr(ctx, ir, out);
+#endif
+  default:
+    return Status::kUnsupported;
+  }
+}
+
+// Generates `to` from an IR module. The module is consumed, as the writers
+// raise it in place.
+static Status IrToOutput(TintContext &ctx, tint::core::ir::Module &ir,
+                         Format to, Conversion &out) {
+  Status status = GenerateFromIr(ctx, ir, to, out);
+  // Measured after the writers grew the module, which is when it is largest
+  AccountIr(ctx, ir);
+  return status;
+}
+
+// The IR pipeline: reads the input straight into core IR and generates the
+// output from it, which skips building an AST program and the AST
+// transforms the writers would otherwise run on a clone of it.
+static Status ConvertOverIr(TintContext &ctx, Format from, Format to,
+                            const void *data, size_t size, Conversion &out) {
+  switch (from) {
+#if TINT_WASM_WGSL_TO_SPIRV
+  case Format::kWgsl: {
+    tint::Source::File source(
+        "input.wgsl",
+        std::string_view(static_cast<const char *>(data), size));
+    // WgslToIR(), with the parse timed like on the AST pipeline
+    auto program = ParseWgsl(ctx, source);
+    AccountProgram(ctx, program);
+    if (!program.IsValid()) {
+      CaptureDiagnostics(program.Diagnostics(), out);
+      return Status::kParseFailed;
+    }
+    Reflect(ctx, program, out);
+    PhaseTimer to_ir(ctx, Phase::kWgslToIr);
+    auto ir = tint::wgsl::reader::ProgramToLoweredIR(program);
+    to_ir.Stop();
+    if (ir != tint::Success) {
+      CaptureDiagnostics(ir.Failure().reason, out);
+      return Status::kParseFailed;
+    }
+    return IrToOutput(ctx, ir.Get(), to, out);
+  }
+#endif
+#if TINT_WASM_SPIRV_TO_WGSL
+  case Format::kSpirv:
+  case Format::kSpvAsm: {
+    std::vector<uint32_t> binary;
+    if (from == Format::kSpvAsm) {
+      Status status = Assemble(ctx, static_cast<const char *>(data), size,
+                               binary, out);
+      if (status != Status::kSuccess) {
+        return status;
+      }
+    } else {
+      auto *words = static_cast<const uint32_t *>(data);
+      binary.assign(words, words + size);
+    }
+    PhaseTimer read(ctx, Phase::kSpirvReadIr);
+    auto ir = tint::spirv::reader::ReadIR(binary);
+    read.Stop();
+    if (ir != tint::Success) {
+      CaptureDiagnostics(ir.Failure().reason, out);
+      return Status::kParseFailed;
+    }
+    return IrToOutput(ctx, ir.Get(), to, out);
+  }
+#endif
+  default:
+    return Status::kUnsupported;
+  }
+}
+
+#if TINT_BUILD_IR_BINARY
+
+// Handles every conversion that starts or ends with an encoded IR blob.
+static Status ConvertIrBlob(TintContext &ctx, Format from, Format to,
+                            const void *data, size_t size, Conversion &out) {
+  if (from == Format::kIrBin) {
+    IrBlobHeader header;
+    if (size < sizeof(header)) {
+      return Status::kInvalidInput;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, kIrBlobMagic, sizeof(header.magic)) != 0) {
+      return Status::kInvalidInput;
+    }
+    if (header.version != kIrBlobVersion ||
+        header.fingerprint != IrBlobFingerprint()) {
+      return Status::kStaleIrBlob;
+    }
+
+    auto *payload = static_cast<const std::byte *>(data) + sizeof(header);
+    if (header.payload_size != size - sizeof(header) ||
+        header.payload_crc != tint::CRC32(payload, header.payload_size)) {
+      return Status::kInvalidInput;
+    }
+    PhaseTimer decode(ctx, Phase::kIrDecode);
+    auto ir = tint::core::ir::binary::Decode(
+        tint::Slice<const std::byte>(payload, size - sizeof(header)));
+    decode.Stop();
+    if (ir != tint::Success) {
+      CaptureDiagnostics(ir.Failure().reason, out);
+      return Status::kParseFailed;
+    }
+    return IrToOutput(ctx, ir.Get(), to, out);
+  }
+
+  // Parse and resolve the input, then encode the resulting core IR
+  return ConvertOverIr(ctx, from, to, data, size, out);
+}
+
+#endif // TINT_BUILD_IR_BINARY
+
+// Runs the conversion `from` -> `to` on `data` and stores the result in
+// `out`. On failure `out.records` explain what went wrong.
+static Status Convert(TintContext &ctx, Format from, Format to,
+                      const void *data, size_t size, Conversion &out) {
+  out.text.clear();
+  out.spirv.clear();
+  out.records.clear();
+  out.reflection = Reflection{};
+  if (!data) {
+    return Status::kInvalidInput;
+  }
+  PhaseTimer timer(ctx, Phase::kConvert);
+
+#if TINT_BUILD_IR_BINARY
+  if (from == Format::kIrBin || to == Format::kIrBin) {
+    return ConvertIrBlob(ctx, from, to, data, size, out);
+  }
+#endif
+
+  // SPIR-V <-> SPIR-V ASM never touches Tint, so only the Tint
+  // conversions can take the IR pipeline
+  bool uses_tint = from == Format::kWgsl || to == Format::kWgsl;
+  if (ctx.options.use_ir && uses_tint && from != to) {
+    return ConvertOverIr(ctx, from, to, data, size, out);
+  }
+
+  switch (from) {
+  case Format::kSpirv: {
+    auto *words = static_cast<const uint32_t *>(data);
+    if (to == Format::kSpvAsm) {
+      return Disassemble(ctx, words, size, out);
+    }
+    if (to == Format::kWgsl) {
+      return SpirvToWgsl(ctx, std::vector<uint32_t>(words, words + size),
+                         out);
+    }
+    break;
+  }
+  case Format::kSpvAsm: {
+    auto *text = static_cast<const char *>(data);
+    if (to == Format::kSpirv) {
+      return Assemble(ctx, text, size, out.spirv, out);
+    }
+    if (to == Format::kWgsl) {
+      std::vector<uint32_t> binary;
+      Status status = Assemble(ctx, text, size, binary, out);
+      if (status != Status::kSuccess) {
+        return status;
+      }
+      return SpirvToWgsl(ctx, binary, out);
+    }
+    break;
+  }
+#if TINT_WASM_WGSL_TO_SPIRV
+  case Format::kWgsl: {
+    auto *text = static_cast<const char *>(data);
+    if (to == Format::kSpirv) {
+      return WgslToSpirv(ctx, text, size, out);
+    }
+    if (to == Format::kSpvAsm) {
+      Status status = WgslToSpirv(ctx, text, size, out);
+      if (status != Status::kSuccess) {
+        return status;
+      }
+      std::vector<uint32_t> binary = std::move(out.spirv);
+      out.spirv.clear();
+      return Disassemble(ctx, binary.data(), binary.size(), out);
+    }
+    break;
+  }
+#endif
+  default:
+    break;
+  }
+  return Status::kUnsupported;
+}
+
+// Identifies a conversion by the hash of its input bytes plus everything
+// that can change its output: the format pair and the context options.
+struct CacheKey {
+  uint64_t hash[2];
+
+  bool operator==(const CacheKey &other) const {
+    return hash[0] == other.hash[0] && hash[1] == other.hash[1];
+  }
+};
+
+struct CacheKeyHasher {
+  size_t operator()(const CacheKey &key) const {
+    return static_cast<size_t>(key.hash[0]);
+  }
+};
+
+// Returns: The context options packed into one word, field by field, so
+//          that cache keys never depend on padding bytes
+static uint64_t OptionsKey(const TintContextOptions &options) {
+  return static_cast<uint64_t>(options.spirv_env) |
+         static_cast<uint64_t>(options.allow_non_uniform_derivatives) << 32 |
+         static_cast<uint64_t>(options.disable_robustness) << 40 |
+         static_cast<uint64_t>(options.disable_workgroup_init) << 48 |
+         static_cast<uint64_t>(options.use_ir) << 56;
+}
+
+static CacheKey MakeCacheKey(const TintContext &ctx, Format from, Format to,
+                             const void *data, size_t size) {
+  size_t bytes = from == Format::kSpirv ? size * sizeof(uint32_t) : size;
+  uint64_t input[2];
+  Murmur3(data, bytes, 0, input);
+
+  // Fold the input hash together with the options, serialized word by word
+  const uint64_t words[] = {
+      input[0],
+      input[1],
+      static_cast<uint64_t>(bytes),
+      OptionsKey(ctx.options),
+      static_cast<uint64_t>(from) | static_cast<uint64_t>(to) << 8 |
+          static_cast<uint64_t>(ctx.reflect ? 1 : 0) << 16,
+      ctx.optimizer_key,
+  };
+
+  CacheKey key;
+  Murmur3(words, sizeof(words), 0, key.hash);
+  return key;
+}
+
+// Process-wide LRU cache of successful conversions, shared by every
+// context. Only successful outputs are kept, along with their warnings.
+class ConversionCache {
+public:
+  bool Lookup(const CacheKey &key, Conversion &out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+      stats_.misses++;
+      return false;
+    }
+    // Move the entry to the front of the LRU list
+    entries_.splice(entries_.begin(), entries_, it->second);
+    out.text = it->second->output.text;
+    out.spirv = it->second->output.spirv;
+    out.records = it->second->output.records;
+    out.reflection = it->second->output.reflection;
+    stats_.hits++;
+    return true;
+  }
+
+  void Insert(const CacheKey &key, const Conversion &out) {
+    size_t bytes = sizeof(Entry) + out.text.size() +
+                   out.spirv.size() * sizeof(uint32_t) +
+                   out.records.size() * sizeof(DiagnosticRecord);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (bytes > stats_.budget || index_.count(key)) {
+      return;
+    }
+    entries_.push_front(Entry{key, out, bytes});
+    index_.emplace(key, entries_.begin());
+    stats_.bytes += static_cast<uint32_t>(bytes);
+    Evict();
+  }
+
+  bool Enabled() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_.budget != 0;
+  }
+
+  void SetBudget(uint32_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.budget = bytes;
+    Evict();
+  }
+
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    index_.clear();
+    stats_.bytes = 0;
+  }
+
+  TintCacheStats Stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    TintCacheStats stats = stats_;
+    stats.entries = static_cast<uint32_t>(entries_.size());
+    return stats;
+  }
+
+private:
+  struct Entry {
+    CacheKey key;
+    Conversion output;
+    size_t bytes;
+  };
+
+  // Drops least recently used entries until the cache fits its budget
+  void Evict() {
+    while (stats_.bytes > stats_.budget && !entries_.empty()) {
+      const Entry &last = entries_.back();
+      stats_.bytes -= static_cast<uint32_t>(last.bytes);
+      stats_.evictions++;
+      index_.erase(last.key);
+      entries_.pop_back();
+    }
+  }
+
+  std::mutex mutex_;
+  std::list<Entry> entries_;
+  std::unordered_map<CacheKey, std::list<Entry>::iterator, CacheKeyHasher>
+      index_;
+  TintCacheStats stats_ = {0, 0, 0, 0, 0, kDefaultCacheBudget};
+};
+
+static ConversionCache conversion_cache;
+
+// Convert(), but served from the conversion cache when the same input was
+// already converted with the same options.
+static Status CachedConvert(TintContext &ctx, Format from, Format to,
+                            const void *data, size_t size, Conversion &out) {
+  ctx.memory = {};
+  if (!data || !conversion_cache.Enabled()) {
+    return Convert(ctx, from, to, data, size, out);
+  }
+
+  PhaseTimer lookup(ctx, Phase::kCacheLookup);
+  CacheKey key = MakeCacheKey(ctx, from, to, data, size);
+  bool hit = conversion_cache.Lookup(key, out);
+  lookup.Stop();
+  if (hit) {
+    return Status::kSuccess;
+  }
+
+  Status status = Convert(ctx, from, to, data, size, out);
+  if (status == Status::kSuccess) {
+    conversion_cache.Insert(key, out);
+  }
+  return status;
+}
+
+// Override values of a specialization, as (id, value) pairs sorted by id.
+using OverrideValues = std::vector<std::pair<uint16_t, double>>;
+
+// An entry point of a TintShader
+struct ShaderEntryPoint {
+  std::string name;
+  tint::ast::PipelineStage stage;
+};
+
+// A WGSL shader parsed and resolved once by tint_shader_create(), kept
+// resident so that tint_shader_specialize() and tint_shader_split() only
+// have to transform the program and run the writer.
+struct TintShader {
+  TintContext *ctx = nullptr;
+
+  // The program points into the source, so it lives as long as the shader
+  std::unique_ptr<tint::Source::File> source;
+  tint::Program program;
+
+  // Ids of the overrides, by name, and the entry points in source order
+  std::map<std::string, tint::OverrideId> override_ids;
+  std::vector<ShaderEntryPoint> entry_points;
+
+  // Hash of the source, which specializations are cached under
+  uint64_t hash[2];
+
+  // Storage backing the tables returned by tint_shader_split()
+  std::vector<TintEntryPointResult> split_results;
+  std::vector<Conversion> split_outputs;
+  std::string split_diagnostics;
+};
+
+// Generates `to` from `shader` on `ctx` with the overrides set to `values`.
+// Overrides missing from `values` keep their initializer. When
+// `entry_point` is set, everything that entry point doesn't use is
+// stripped first.
+static Status Specialize(TintContext &ctx, const TintShader &shader,
+                         Format to, const OverrideValues &values,
+                         const std::string &entry_point, Conversion &out) {
+  PhaseTimer timer(ctx, Phase::kConvert);
+
+  tint::ast::transform::Manager manager;
+  tint::ast::transform::DataMap inputs;
+  if (!entry_point.empty()) {
+    manager.Add<tint::ast::transform::SingleEntryPoint>();
+    inputs.Add<tint::ast::transform::SingleEntryPoint::Config>(entry_point);
+  }
+  tint::ast::transform::SubstituteOverride::Config config;
+  for (const auto &value : values) {
+    config.map[tint::OverrideId{value.first}] = value.second;
+  }
+  manager.Add<tint::ast::transform::SubstituteOverride>();
+  inputs.Add<tint::ast::transform::SubstituteOverride::Config>(config);
+  tint::ast::transform::DataMap outputs;
+
+  PhaseTimer specialize(ctx, Phase::kWgslSpecialize);
+  tint::Program program = manager.Run(shader.program, inputs, outputs);
+  specialize.Stop();
+  AccountProgram(ctx, program);
+  if (!program.IsValid()) {
+    CaptureDiagnostics(program.Diagnostics(), out);
+    return Status::kGenerateFailed;
+  }
+
+  if (ctx.options.use_ir && to != Format::kWgsl) {
+    PhaseTimer to_ir(ctx, Phase::kWgslToIr);
+    auto ir = tint::wgsl::reader::ProgramToLoweredIR(program);
+    to_ir.Stop();
+    if (ir != tint::Success) {
+      CaptureDiagnostics(ir.Failure().reason, out);
+      return Status::kGenerateFailed;
+    }
+    return IrToOutput(ctx, ir.Get(), to, out);
+  }
+  return ProgramToOutput(ctx, program, to, out);
+}
+
+// Specialize(), but served from the conversion cache when the shader was
+// already specialized the same way.
+static Status CachedSpecialize(TintContext &ctx, const TintShader &shader,
+                               Format to, const OverrideValues &values,
+                               const std::string &entry_point,
+                               Conversion &out) {
+  ctx.memory = {};
+  out.text.clear();
+  out.spirv.clear();
+  out.records.clear();
+  if (!conversion_cache.Enabled()) {
+    return Specialize(ctx, shader, to, values, entry_point, out);
+  }
+
+  PhaseTimer lookup(ctx, Phase::kCacheLookup);
+  uint64_t entry_point_hash[2];
+  Murmur3(entry_point.data(), entry_point.size(), 0, entry_point_hash);
+  std::vector<uint64_t> words = {shader.hash[0], shader.hash[1],
+                                 entry_point_hash[0], entry_point_hash[1],
+                                 static_cast<uint64_t>(to)};
+  words.push_back(OptionsKey(ctx.options));
+  words.push_back(ctx.optimizer_key);
+  for (const auto &value : values) {
+    uint64_t bits;
+    std::memcpy(&bits, &value.second, sizeof(bits));
+    words.push_back(value.first);
+    words.push_back(bits);
+  }
+  CacheKey key;
+  Murmur3(words.data(), words.size() * sizeof(uint64_t), 0, key.hash);
+  bool hit = conversion_cache.Lookup(key, out);
+  lookup.Stop();
+  if (hit) {
+    return Status::kSuccess;
+  }
+
+  Status status = Specialize(ctx, shader, to, values, entry_point, out);
+  if (status == Status::kSuccess) {
+    conversion_cache.Insert(key, out);
+  }
+  return status;
+}
+
+// Fills in everything but the diagnostics offset of a batch result row.
+static void FillBatchResult(Status status, Format to, const Conversion &out,
+                            TintBatchResult &result) {
+  result.status = static_cast<uint32_t>(status);
+  result.output = nullptr;
+  result.size = 0;
+  if (status == Status::kSuccess) {
+    if (to == Format::kSpirv) {
+      result.output = out.spirv.data();
+      result.size = static_cast<uint32_t>(out.spirv.size());
+    } else {
+      result.output = out.text.c_str();
+      result.size = static_cast<uint32_t>(out.text.size());
+    }
+  }
+}
+
+#if TINT_WASM_THREADS
+
+// Number of compile workers. Keep this in sync with -sPTHREAD_POOL_SIZE so
+// that starting the pool never has to wait on a new Web Worker.
+#ifndef TINT_WASM_WORKERS
+#define TINT_WASM_WORKERS 8
+#endif
+
+// Settings of the context a task was queued from. The worker running the
+// task converts with them, so that its output is the same as the one the
+// context would have produced itself.
+struct ContextSettings {
+  TintContextOptions options = kDefaultContextOptions;
+  bool reflect = false;
+  bool diagnostic_text = true;
+  OptimizeMode optimize_mode = OptimizeMode::kNone;
+  std::string optimizer_flags;
+  uint64_t optimizer_key = 0;
+};
+
+// Returns: The settings of `ctx`, shared by the tasks queued from it
+static std::shared_ptr<const ContextSettings>
+SettingsOf(const TintContext &ctx) {
+  auto settings = std::make_shared<ContextSettings>();
+  settings->options = ctx.options;
+  settings->reflect = ctx.reflect;
+  settings->diagnostic_text = ctx.diagnostic_text;
+  settings->optimize_mode = ctx.optimize_mode;
+  settings->optimizer_flags = ctx.optimizer_flags;
+  settings->optimizer_key = ctx.optimizer_key;
+  return settings;
+}
+
+// Sets the private context of a worker up with `settings`. The context is
+// only created again when its options change, and the optimizer only
+// rebuilt when the pass list does.
+static void Configure(std::unique_ptr<TintContext> &ctx,
+                      const ContextSettings &settings) {
+  if (!ctx || OptionsKey(ctx->options) != OptionsKey(settings.options)) {
+    ctx = std::make_unique<TintContext>(settings.options);
+  }
+  ctx->reflect = settings.reflect;
+  ctx->diagnostic_text = settings.diagnostic_text;
+  if (ctx->optimizer_key != settings.optimizer_key) {
+    SetOptimizer(*ctx, settings.optimize_mode, settings.optimizer_flags);
+  }
+}
+
+// A batch handed to the worker pool by tint_batch_compile_async().
+struct TintJob {
+  std::vector<TintBatchInput> inputs;
+  std::vector<TintBatchResult> results;
+  std::vector<Conversion> outputs;
+  std::string diagnostics;
+
+  // Settings of the default context when the job was queued
+  std::shared_ptr<const ContextSettings> settings;
+
+  // Number of shaders that still have to be converted
+  std::atomic<uint32_t> remaining{0};
+  std::atomic<bool> done{false};
+
+  // Signalled once the whole batch is converted
+  std::mutex mutex;
+  std::condition_variable finished;
+
+  TintJobCallback callback = nullptr;
+  void *user_data = nullptr;
+
+  // Guarded by `mutex`: set while the callback is posted but hasn't
+  // returned yet, and set by tint_job_release() if it was called in the
+  // meantime, so that the job is deleted once the callback is done with it
+  bool callback_pending = false;
+  bool released = false;
+};
+
+// A conversion started by tint_convert_async(). The input is copied so
+// that the caller can release it straight away. The request is shared by
+// the registry and the queued task, so that it can be finished by
+// tint_request_result() while a worker still holds on to it.
+struct AsyncRequest {
+  uint32_t id = 0;
+  Format from = Format::kWgsl;
+  Format to = Format::kWgsl;
+  std::vector<uint32_t> input;
+  size_t size = 0;
+  Conversion out;
+
+  // Settings of the default context when the request was queued, which
+  // the worker converts with and tint_request_result() formats with
+  std::shared_ptr<const ContextSettings> settings;
+
+  // Guarded by the registry mutex: kTintRequestPending until the request
+  // completes, and whether a worker picked it up
+  uint32_t status = kTintRequestPending;
+  bool started = false;
+
+  // Set by tint_request_cancel(), read by the worker between stages
+  std::atomic<bool> cancel{false};
+
+  TintRequestCallback callback = nullptr;
+  void *user_data = nullptr;
+};
+
+// Every request that has not been finished by tint_request_result() yet,
+// by request id.
+struct AsyncRequests {
+  std::mutex mutex;
+  std::unordered_map<uint32_t, std::shared_ptr<AsyncRequest>> requests;
+};
+
+static AsyncRequests &Requests() {
+  static AsyncRequests requests;
+  return requests;
+}
+
+// Fixed pool of compile threads. Every shader of a job and every request
+// is queued on its own, so one large shader doesn't hold up the rest of
+// the batch. Each worker converts on a private context, set up with the
+// settings the task was queued with.
+class WorkerPool {
+public:
+  explicit WorkerPool(uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+      threads_.emplace_back([this] { Run(); });
+    }
+  }
+
+  ~WorkerPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto &thread : threads_) {
+      thread.join();
+    }
+  }
+
+  void Submit(TintJob *job) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (uint32_t i = 0; i < job->inputs.size(); i++) {
+        queue_.push_back(Task{job->settings, [job, i](TintContext &ctx) {
+                                ConvertJobInput(ctx, job, i);
+                              }});
+      }
+    }
+    wake_.notify_all();
+  }
+
+  void Submit(std::shared_ptr<AsyncRequest> request) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      std::shared_ptr<const ContextSettings> settings = request->settings;
+      queue_.push_back(
+          Task{std::move(settings),
+               [request = std::move(request)](TintContext &ctx) {
+                 RunRequest(ctx, *request);
+               }});
+    }
+    wake_.notify_all();
+  }
+
+  // Queues `count` calls of `run`, one per index, and blocks until all of
+  // them returned. Must not be called from a worker.
+  void RunAll(std::shared_ptr<const ContextSettings> settings, size_t count,
+              const std::function<void(TintContext &, size_t)> &run) {
+    std::mutex mutex;
+    std::condition_variable finished;
+    size_t remaining = count;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (size_t i = 0; i < count; i++) {
+        queue_.push_back(Task{settings, [&, i](TintContext &ctx) {
+                                run(ctx, i);
+                                std::lock_guard<std::mutex> lock(mutex);
+                                if (--remaining == 0) {
+                                  finished.notify_all();
+                                }
+                              }});
+      }
+    }
+    wake_.notify_all();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [&] { return remaining == 0; });
+  }
+
+  // Stores the outcome of a request and reports it through its callback.
+  // A request cancelled while it ran completes as kCancelled, whatever
+  // the conversion returned. Does nothing if the request completed
+  // already, so that it is only ever reported once.
+  static void Complete(AsyncRequest &request, Status status) {
+    {
+      std::lock_guard<std::mutex> lock(Requests().mutex);
+      if (request.status != kTintRequestPending) {
+        return;
+      }
+      if (request.cancel) {
+        status = Status::kCancelled;
+        request.out = Conversion{};
+      }
+      request.status = static_cast<uint32_t>(status);
+    }
+    Notify(request, status);
+  }
+
+  // Runs the callback of a request that just completed with `status`. Must
+  // be called without holding the registry lock.
+  static void Notify(const AsyncRequest &request, Status status) {
+    if (request.callback) {
+#if defined(__EMSCRIPTEN__)
+      emscripten_async_run_in_main_runtime_thread(
+          EM_FUNC_SIG_VIII, reinterpret_cast<void *>(request.callback),
+          request.id, static_cast<uint32_t>(status), request.user_data);
+#else
+      request.callback(request.id, static_cast<uint32_t>(status),
+                       request.user_data);
+#endif
+    }
+  }
+
+  // Marks `job` done and reports it through its callback. Jobs without
+  // shaders are done straight away, the rest once Finish() laid them out.
+  static void Done(TintJob *job) {
+    // The job may be released as soon as `done` is set. With a callback
+    // still to run, tint_job_release() leaves the deleting to
+    // RunJobCallback(), so the callback never sees a released job.
+    bool callback = job->callback != nullptr;
+    {
+      std::lock_guard<std::mutex> lock(job->mutex);
+      job->callback_pending = callback;
+      job->done = true;
+      job->finished.notify_all();
+    }
+
+    if (callback) {
+#if defined(__EMSCRIPTEN__)
+      // JS callbacks have to run on the thread that owns the JS state
+      emscripten_async_run_in_main_runtime_thread(
+          EM_FUNC_SIG_VI, reinterpret_cast<void *>(RunJobCallback), job);
+#else
+      RunJobCallback(job);
+#endif
+    }
+  }
+
+private:
+  void Run() {
+    std::unique_ptr<TintContext> ctx;
+    for (;;) {
+      Task task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        wake_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) {
+          return;
+        }
+        task = std::move(queue_.front());
+        queue_.pop_front();
+      }
+      Configure(ctx, *task.settings);
+      task.run(*ctx);
+    }
+  }
+
+  static void ConvertJobInput(TintContext &ctx, TintJob *job, uint32_t i) {
+    const TintBatchInput &input = job->inputs[i];
+    Conversion &out = job->outputs[i];
+    Status status = CachedConvert(ctx, static_cast<Format>(input.from),
+                                  static_cast<Format>(input.to), input.data,
+                                  input.size, out);
+    FillBatchResult(status, static_cast<Format>(input.to), out,
+                    job->results[i]);
+
+    if (job->remaining.fetch_sub(1) == 1) {
+      Finish(ctx, job);
+    }
+  }
+
+  static void RunRequest(TintContext &ctx, AsyncRequest &request) {
+    {
+      // Requests cancelled while queued have completed already
+      std::lock_guard<std::mutex> lock(Requests().mutex);
+      if (request.status != kTintRequestPending) {
+        return;
+      }
+      request.started = true;
+    }
+
+    ctx.cancel = &request.cancel;
+    Status status = CachedConvert(ctx, request.from, request.to,
+                                  request.input.data(), request.size,
+                                  request.out);
+    ctx.cancel = nullptr;
+    Complete(request, status);
+  }
+
+  // Called by whichever worker converted the last shader of `job`
+  static void Finish(const TintContext &ctx, TintJob *job) {
+    // Lay the diagnostics out in input order, like tint_batch_compile()
+    for (size_t i = 0; i < job->outputs.size(); i++) {
+      job->results[i].diagnostics = AppendDiagnosticText(
+          ctx, job->outputs[i].records, job->diagnostics);
+    }
+    Done(job);
+  }
+
+  // Calls the callback of a finished job, unless the job was released
+  // before it got to run, and deletes the job if it was released before
+  // or during the callback.
+  static void RunJobCallback(TintJob *job) {
+    bool released;
+    {
+      std::lock_guard<std::mutex> lock(job->mutex);
+      released = job->released;
+    }
+    if (!released) {
+      job->callback(job, job->user_data);
+    }
+    {
+      std::lock_guard<std::mutex> lock(job->mutex);
+      job->callback_pending = false;
+      released = job->released;
+    }
+    if (released) {
+      delete job;
+    }
+  }
+
+  struct Task {
+    std::shared_ptr<const ContextSettings> settings;
+    std::function<void(TintContext &)> run;
+  };
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::deque<Task> queue_;
+  std::vector<std::thread> threads_;
+  bool stopping_ = false;
+};
+
+// The pool is started on the first asynchronous batch.
+static WorkerPool &Workers() {
+  static WorkerPool pool(TINT_WASM_WORKERS);
+  return pool;
+}
+
+// Context that tint_request_result() hands request outputs over from, so
+// that finishing a request doesn't replace the diagnostics and reflection
+// of the last conversion on the default context.
+static TintContext &RequestContext() {
+  static TintContext context(kDefaultContextOptions);
+  return context;
+}
+
+#endif // TINT_WASM_THREADS
+
+// Turns the overrides passed to tint_shader_specialize() into ids, sorted
+// so that the cache key doesn't depend on the order they were passed in.
+// Returns: false if an override name or id is not declared by the shader
+static bool ResolveOverrides(const TintShader &shader,
+                             const TintOverride *overrides, uint32_t count,
+                             OverrideValues &values) {
+  values.clear();
+  values.reserve(count);
+  for (uint32_t i = 0; i < count; i++) {
+    uint32_t id = overrides[i].id;
+    if (overrides[i].name) {
+      auto it = shader.override_ids.find(overrides[i].name);
+      if (it == shader.override_ids.end()) {
+        return false;
+      }
+      id = it->second.value;
+    } else if (id > UINT16_MAX ||
+               std::none_of(shader.override_ids.begin(),
+                            shader.override_ids.end(), [&](const auto &entry) {
+                              return entry.second.value == id;
+                            })) {
+      return false;
+    }
+    values.emplace_back(static_cast<uint16_t>(id), overrides[i].value);
+  }
+  std::sort(values.begin(), values.end());
+  return true;
+}
+
+// Generates one module per entry point of `shader` into its split tables.
+// In the threaded build `parallel` queues the entry points on the worker
+// pool, converted with the settings of the shader's context. They only
+// read the shared program, which the transforms clone before changing
+// anything.
+static void SplitEntryPoints(TintShader &shader, Format to,
+                             const OverrideValues &values, bool parallel) {
+  size_t count = shader.entry_points.size();
+  shader.split_results.resize(count);
+  if (shader.split_outputs.size() < count) {
+    shader.split_outputs.resize(count);
+  }
+  shader.split_diagnostics.clear();
+
+  auto split = [&](TintContext &ctx, size_t i) {
+    const ShaderEntryPoint &entry_point = shader.entry_points[i];
+    Conversion &out = shader.split_outputs[i];
+    Status status =
+        CachedSpecialize(ctx, shader, to, values, entry_point.name, out);
+    TintEntryPointResult &row = shader.split_results[i];
+    row.name = entry_point.name.c_str();
+    row.stage = static_cast<uint32_t>(entry_point.stage);
+    FillBatchResult(status, to, out, row.result);
+  };
+
+#if TINT_WASM_THREADS
+  if (parallel && count > 1) {
+    Workers().RunAll(SettingsOf(*shader.ctx), count, split);
+  } else
+#endif
+  {
+    (void)parallel;
+    for (size_t i = 0; i < count; i++) {
+      split(*shader.ctx, i);
+    }
+  }
+
+  // Lay the diagnostics out in entry point order, like the batch tables
+  for (size_t i = 0; i < count; i++) {
+    shader.split_results[i].result.diagnostics =
+        AppendDiagnosticText(*shader.ctx, shader.split_outputs[i].records,
+                             shader.split_diagnostics);
+  }
+}
+
+// A diagnostic of a TintDocument declaration. Its position is kept as an
+// offset from the start of the declaration, so that the record stays valid
+// while edits before it move the declaration around.
+struct DocumentRecord {
+  uint32_t offset = 0;
+  DiagnosticRecord record;
+};
+
+// A top-level declaration or directive of a TintDocument. The declarations
+// cover the text without gaps: each one starts where the previous one
+// ended, comments and attributes included, and ends after the ';' or '}'
+// that closes it at brace depth 0.
+struct DocumentDecl {
+  uint32_t begin = 0;
+  uint32_t end = 0;
+  uint64_t hash[2] = {0, 0};
+
+  // Declared name, empty for directives and const_assert
+  std::string name;
+  // Every identifier the declaration spells, sorted. This is a superset of
+  // the globals it depends on, as locals and members are in it too.
+  std::vector<std::string> references;
+  bool directive = false;
+  bool is_override = false;
+  // Not closed by ';' or '}', so it runs to the end of the text
+  bool open = false;
+
+  // Changed by an edit since the last check
+  bool dirty = true;
+  // Resolved since it last changed. Resolving stops at the first error, so
+  // declarations resolved along with an error stay unverified until the
+  // declarations with errors change.
+  bool verified = false;
+  std::vector<DocumentRecord> parse_records;
+  std::vector<DocumentRecord> resolve_records;
+};
+
+// A WGSL document being edited, see tint_context_document_create(). Edits
+// only relex the declarations they touch, and checks only parse and
+// resolve the declarations that changed, the ones that share a name with
+// or refer to them, and what those depend on.
+struct TintDocument {
+  TintContext *ctx = nullptr;
+  std::string text;
+  std::vector<DocumentDecl> decls;
+
+  // Names of the declarations edits removed since the last check, and
+  // whether a directive or an override was among them
+  std::set<std::string> removed_names;
+  bool removed_directive = false;
+  bool removed_override = false;
+
+  // Diagnostics of the last check that have no position in the text
+  std::vector<DiagnosticRecord> unplaced;
+  // Diagnostics of every declaration, laid out by the last check
+  std::vector<DiagnosticRecord> records;
+  Status status = Status::kSuccess;
+  bool checked = false;
+
+  // See TintDocumentStats. `relexed_bytes` counts the edits since the
+  // last check, `checked_relexed_bytes` the ones before it.
+  uint32_t checked_decls = 0;
+  uint32_t relexed_bytes = 0;
+  uint32_t checked_relexed_bytes = 0;
+};
+
+#if TINT_WASM_WGSL_TO_SPIRV
+
+// Lexes `text[from, to)` into declarations, which are appended to `out`.
+// Lexing stops at the first lexer error. With `last` set the region runs
+// to the end of the text, and tokens after the last closed declaration
+// make up an open one.
+// Returns: The end of the last declaration closed in the region, or `from`
+static uint32_t LexDecls(std::string_view text, uint32_t from, uint32_t to,
+                         bool last, std::vector<DocumentDecl> &out) {
+  using Type = tint::wgsl::reader::Token::Type;
+  tint::Source::File file("input.wgsl", text.substr(from, to - from));
+  tint::wgsl::reader::Lexer lexer(&file);
+  auto offset_of = [&](const tint::Source::Location &location) {
+    const char *line = file.content.lines[location.line - 1].data();
+    return from + static_cast<uint32_t>(line - file.content.data.data()) +
+           location.column - 1;
+  };
+  auto close = [&](DocumentDecl &decl, uint32_t end) {
+    decl.end = end;
+    Murmur3(text.data() + decl.begin, decl.end - decl.begin, 0, decl.hash);
+    std::sort(decl.references.begin(), decl.references.end());
+    decl.references.erase(
+        std::unique(decl.references.begin(), decl.references.end()),
+        decl.references.end());
+    out.push_back(std::move(decl));
+  };
+
+  uint32_t closed = from;
+  DocumentDecl decl;
+  decl.begin = from;
+  bool empty = true;
+  int depth = 0;
+  // The declared name comes next, after the template list of a var
+  bool name_next = false;
+  int template_depth = 0;
+  for (;;) {
+    tint::wgsl::reader::Token token = lexer.Next();
+    if (token.IsEof()) {
+      break;
+    }
+    if (token.IsError()) {
+      // Keeps the rest of the text in a declaration, which the parser will
+      // report the error for
+      empty = false;
+      break;
+    }
+    Type type = token.type();
+    if (empty) {
+      empty = false;
+      decl.directive = type == Type::kEnable || type == Type::kRequires ||
+                       type == Type::kDiagnostic;
+    }
+    switch (type) {
+    case Type::kIdentifier:
+      decl.references.emplace_back(token.to_str_view());
+      if (name_next && template_depth == 0) {
+        decl.name = decl.references.back();
+        name_next = false;
+      }
+      break;
+    case Type::kAlias:
+    case Type::kConst:
+    case Type::kFn:
+    case Type::kOverride:
+    case Type::kStruct:
+    case Type::kVar:
+      if (depth == 0 && decl.name.empty()) {
+        name_next = true;
+        decl.is_override = type == Type::kOverride;
+      }
+      break;
+    case Type::kLessThan:
+      template_depth += name_next ? 1 : 0;
+      break;
+    case Type::kGreaterThan:
+      template_depth -= template_depth > 0 ? 1 : 0;
+      break;
+    case Type::kBraceLeft:
+      depth++;
+      break;
+    case Type::kBraceRight:
+    case Type::kSemicolon:
+      if (type == Type::kBraceRight) {
+        depth--;
+      }
+      if (depth <= 0) {
+        closed = offset_of(token.source().range.begin) + 1;
+        close(decl, closed);
+        decl = DocumentDecl{};
+        decl.begin = closed;
+        empty = true;
+        depth = 0;
+        name_next = false;
+        template_depth = 0;
+      }
+      break;
+    default:
+      break;
+    }
+  }
+  if (last && !empty) {
+    decl.open = true;
+    close(decl, to);
+  }
+  return closed;
+}
+
+// Replaces `doc.text[begin, end)` with `insert` and relexes the text from
+// the first declaration the edit touches, until a declaration ends where
+// one of the old declarations after the edit ended. From there on the old
+// declarations are kept, moved by the size difference. Relexed
+// declarations with the text of one they replace take over its state.
+static void EditDocument(TintDocument &doc, uint32_t begin, uint32_t end,
+                         std::string_view insert) {
+  std::vector<DocumentDecl> &decls = doc.decls;
+  size_t first = static_cast<size_t>(
+      std::partition_point(decls.begin(), decls.end(),
+                           [&](const DocumentDecl &decl) {
+                             return decl.end <= begin && !decl.open;
+                           }) -
+      decls.begin());
+  uint32_t start = first ? decls[first - 1].end : 0;
+  int64_t delta = static_cast<int64_t>(insert.size()) -
+                  static_cast<int64_t>(end - begin);
+  doc.text.replace(begin, end - begin, insert);
+
+  // Old declarations that end at or after the end of the edit are followed
+  // by unchanged text. Once a relexed declaration ends where one of them
+  // ended, moved by `delta`, the rest of the text lexes the same as before.
+  size_t old = first;
+  while (old < decls.size() && decls[old].end < end) {
+    old++;
+  }
+  auto resyncs = [&](uint32_t offset) {
+    while (old < decls.size() && !decls[old].open &&
+           decls[old].end + delta < offset) {
+      old++;
+    }
+    return old < decls.size() && !decls[old].open &&
+           decls[old].end + delta == offset;
+  };
+
+  // Lex up to the end of the next such declaration, and twice as many
+  // declarations further each time the boundaries don't line up
+  std::vector<DocumentDecl> lexed;
+  size_t kept = decls.size();
+  uint32_t from = start;
+  uint32_t to = start;
+  size_t next = old;
+  size_t step = 1;
+  bool resynced = resyncs(start);
+  while (!resynced) {
+    size_t target = std::min(next + step - 1, decls.size());
+    bool last = target >= decls.size() || decls[target].open;
+    to = last ? static_cast<uint32_t>(doc.text.size())
+              : static_cast<uint32_t>(decls[target].end + delta);
+    size_t before = lexed.size();
+    from = LexDecls(doc.text, from, to, last, lexed);
+    for (size_t i = before; i < lexed.size(); i++) {
+      if (!lexed[i].open && resyncs(lexed[i].end)) {
+        lexed.resize(i + 1);
+        resynced = true;
+        break;
+      }
+    }
+    if (last) {
+      break;
+    }
+    next = target + 1;
+    step *= 2;
+  }
+  if (resynced) {
+    kept = old + 1;
+  }
+  doc.relexed_bytes += to - start;
+
+  std::vector<DocumentDecl> removed(
+      std::make_move_iterator(decls.begin() + first),
+      std::make_move_iterator(decls.begin() + kept));
+  for (DocumentDecl &decl : lexed) {
+    auto same = std::find_if(
+        removed.begin(), removed.end(), [&](const DocumentDecl &old) {
+          return old.end - old.begin == decl.end - decl.begin &&
+                 old.hash[0] == decl.hash[0] && old.hash[1] == decl.hash[1];
+        });
+    if (same != removed.end()) {
+      decl.dirty = same->dirty;
+      decl.verified = same->verified;
+      decl.parse_records = std::move(same->parse_records);
+      decl.resolve_records = std::move(same->resolve_records);
+      removed.erase(same);
+    }
+  }
+  for (const DocumentDecl &old : removed) {
+    if (!old.name.empty()) {
+      doc.removed_names.insert(old.name);
+    }
+    doc.removed_directive |= old.directive;
+    doc.removed_override |= old.is_override;
+  }
+
+  for (size_t i = kept; i < decls.size(); i++) {
+    decls[i].begin = static_cast<uint32_t>(decls[i].begin + delta);
+    decls[i].end = static_cast<uint32_t>(decls[i].end + delta);
+  }
+  decls.erase(decls.begin() + first, decls.begin() + kept);
+  decls.insert(decls.begin() + first, std::make_move_iterator(lexed.begin()),
+               std::make_move_iterator(lexed.end()));
+}
+
+// Replaces everything but the line breaks in `text[begin, end)` with
+// spaces, so that the rest of the text keeps its lines and columns.
+static void BlankOut(std::string &text, size_t begin, size_t end) {
+  std::string_view view(text.data(), end);
+  while (begin < end) {
+    size_t lead = tint::FindLineBreakLead(view, begin);
+    std::memset(&text[begin], ' ', lead - begin);
+    if (lead == end) {
+      break;
+    }
+    // A lone lead byte of U+0085, U+2028 or U+2029 is blanked as well
+    std::string_view rest = view.substr(lead);
+    size_t length = 1;
+    if (rest[0] == '\xc2') {
+      length = rest.substr(0, 2) == "\xc2\x85" ? 2 : 0;
+    } else if (rest[0] == '\xe2') {
+      length = rest.substr(0, 3) == "\xe2\x80\xa8" ||
+                       rest.substr(0, 3) == "\xe2\x80\xa9"
+                   ? 3
+                   : 0;
+    }
+    if (length == 0) {
+      text[lead] = ' ';
+      length = 1;
+    }
+    begin = lead + length;
+  }
+}
+
+// Lays the diagnostics of every declaration of `doc` out in `doc.records`.
+// Like a full parse, a document with syntax errors only reports those.
+static void LayOutDocumentRecords(TintDocument &doc) {
+  bool parse_failed = false;
+  for (const DocumentDecl &decl : doc.decls) {
+    parse_failed |= !decl.parse_records.empty();
+  }
+  tint::LineIndex lines(doc.text);
+  doc.records.clear();
+  doc.status = Status::kSuccess;
+  for (const DocumentDecl &decl : doc.decls) {
+    for (const DocumentRecord &placed :
+         parse_failed ? decl.parse_records : decl.resolve_records) {
+      DiagnosticRecord record = placed.record;
+      tint::Source::Location location =
+          lines.Locate(decl.begin + placed.offset);
+      record.line = location.line;
+      record.column = location.column;
+      doc.records.push_back(std::move(record));
+    }
+  }
+  doc.records.insert(doc.records.end(), doc.unplaced.begin(),
+                     doc.unplaced.end());
+  for (const DiagnosticRecord &record : doc.records) {
+    if (record.severity == Severity::kError) {
+      doc.status = Status::kParseFailed;
+    }
+  }
+}
+
+// Hashes the declaration names a check looks up, 16 bytes at a time in
+// the SIMD build. Unlike the cache keys these only pick a bucket, so a
+// 32-bit hash is plenty.
+struct NameHash {
+  size_t operator()(std::string_view name) const {
+    return tint::HashBytes(name.data(), name.size());
+  }
 };
 
-// Using static global variables to store the generated shader code
-// resolves an issue with the WebAssembly module not returning the
-// wgsl code specifically.
-// I don't see an issue with this as this is a simple demo module.
-static std::string wgsl_gen;
-static std::string spv_asm_gen;
-static std::vector<uint32_t> spv_bin_gen;
+// Returns: Per declaration of `doc`, whether the last check that covered
+//          it reported an error in it
+static std::vector<uint8_t> ErroringDecls(const TintDocument &doc) {
+  std::vector<uint8_t> erroring(doc.decls.size(), 0);
+  for (size_t i = 0; i < doc.decls.size(); i++) {
+    for (const auto *records :
+         {&doc.decls[i].parse_records, &doc.decls[i].resolve_records}) {
+      for (const DocumentRecord &placed : *records) {
+        erroring[i] |= placed.record.severity == Severity::kError;
+      }
+    }
+  }
+  return erroring;
+}
+
+// Parses and resolves the declarations in `subset`, plus everything they
+// need to resolve, with everything else blanked out, and stores their
+// diagnostics. `subset` is extended by what was added.
+// Returns: The number of declarations checked
+static uint32_t CheckSubset(
+    TintDocument &doc, std::vector<uint8_t> &subset,
+    const std::vector<std::vector<uint32_t>> &dependencies) {
+  std::vector<DocumentDecl> &decls = doc.decls;
+  const size_t count = decls.size();
+  std::vector<uint32_t> work;
+  for (uint32_t i = 0; i < count; i++) {
+    if (subset[i]) {
+      work.push_back(i);
+    }
+  }
+  while (!work.empty()) {
+    uint32_t i = work.back();
+    work.pop_back();
+    for (uint32_t dependency : dependencies[i]) {
+      if (!subset[dependency]) {
+        subset[dependency] = 1;
+        work.push_back(dependency);
+      }
+    }
+  }
+
+  std::string blanked = doc.text;
+  uint32_t checked = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    if (subset[i]) {
+      checked++;
+    } else {
+      BlankOut(blanked, decls[i].begin, decls[i].end);
+    }
+  }
+  tint::Source::File file("input.wgsl", blanked);
+  bool parsed = false;
+  tint::Program program = ParseWgsl(*doc.ctx, file, &parsed);
+
+  for (uint32_t i = 0; i < count; i++) {
+    if (subset[i]) {
+      decls[i].parse_records.clear();
+      if (parsed) {
+        decls[i].resolve_records.clear();
+      }
+    }
+  }
+  doc.unplaced.clear();
+  Conversion captured;
+  CaptureDiagnostics(program.Diagnostics(), captured);
+  tint::LineIndex lines(blanked);
+  size_t owner = count;
+  size_t index = 0;
+  for (const tint::diag::Diagnostic &diagnostic : program.Diagnostics()) {
+    DiagnosticRecord &record = captured.records[index++];
+    const tint::Source::Location &location = diagnostic.source.range.begin;
+    if (location.line == 0 || count == 0) {
+      doc.unplaced.push_back(std::move(record));
+      continue;
+    }
+    size_t offset = lines.Offset(location);
+    // Notes stay with the diagnostic they belong to
+    if (diagnostic.severity != tint::diag::Severity::Note || owner == count) {
+      owner = static_cast<size_t>(
+          std::partition_point(decls.begin(), decls.end(),
+                               [&](const DocumentDecl &decl) {
+                                 return decl.end <= offset;
+                               }) -
+          decls.begin());
+      owner = std::min(owner, count - 1);
+      while (owner > 0 && !subset[owner]) {
+        owner--;
+      }
+    }
+    if (owner >= count || !subset[owner]) {
+      doc.unplaced.push_back(std::move(record));
+      continue;
+    }
+    DocumentDecl &decl = decls[owner];
+    DocumentRecord placed;
+    placed.offset = static_cast<uint32_t>(offset - decl.begin);
+    placed.record = std::move(record);
+    (parsed ? decl.resolve_records : decl.parse_records)
+        .push_back(std::move(placed));
+  }
+
+  for (uint32_t i = 0; i < count; i++) {
+    DocumentDecl &decl = decls[i];
+    if (!subset[i]) {
+      continue;
+    }
+    decl.dirty = false;
+    decl.verified = parsed && program.IsValid();
+    for (const DocumentRecord &placed : decl.resolve_records) {
+      decl.verified |= parsed && placed.record.severity == Severity::kError;
+    }
+  }
+  return checked;
+}
+
+// Parses and resolves the declarations of `doc` that may have different
+// diagnostics since the last check, and keeps the diagnostics of the rest.
+// Those declarations are found on a lexical dependency graph: a
+// declaration depends on every declaration named by one of its
+// identifiers. The subset is parsed and resolved as a copy of the text
+// with everything else blanked out, so that its diagnostics come out at
+// their positions in the document.
+//
+// Declarations with errors are always part of the subset, as Tint stops
+// at the first error and a check without them would get further than a
+// full one. Declarations left unverified by an earlier error are only
+// checked again once the declarations with errors change, since until
+// then a full check wouldn't get to them either.
+static Status CheckDocument(TintDocument &doc) {
+  std::vector<DocumentDecl> &decls = doc.decls;
+  bool changed = !doc.checked || !doc.removed_names.empty() ||
+                 doc.removed_directive || doc.removed_override;
+  for (const DocumentDecl &decl : decls) {
+    changed |= decl.dirty;
+  }
+  if (!changed) {
+    doc.checked_decls = 0;
+    return doc.status;
+  }
+
+  const size_t count = decls.size();
+  std::unordered_map<std::string_view, std::vector<uint32_t>, NameHash>
+      declared;
+  for (uint32_t i = 0; i < count; i++) {
+    if (!decls[i].name.empty()) {
+      declared[decls[i].name].push_back(i);
+    }
+  }
+  std::vector<std::vector<uint32_t>> dependencies(count);
+  std::vector<std::vector<uint32_t>> dependents(count);
+  for (uint32_t i = 0; i < count; i++) {
+    for (const std::string &reference : decls[i].references) {
+      auto it = declared.find(reference);
+      if (it == declared.end()) {
+        continue;
+      }
+      for (uint32_t dependency : it->second) {
+        if (dependency != i) {
+          dependencies[i].push_back(dependency);
+          dependents[dependency].push_back(i);
+        }
+      }
+    }
+  }
+
+  // Start from what changed and whatever names the same globals
+  std::vector<uint8_t> subset(count, 0);
+  std::vector<uint32_t> work;
+  auto add = [&](uint32_t i) {
+    if (!subset[i]) {
+      subset[i] = 1;
+      work.push_back(i);
+    }
+  };
+  bool all = !doc.checked || doc.removed_directive;
+  bool overrides = doc.removed_override;
+  std::unordered_set<std::string_view, NameHash> names(
+      doc.removed_names.begin(), doc.removed_names.end());
+  for (uint32_t i = 0; i < count; i++) {
+    const DocumentDecl &decl = decls[i];
+    if (decl.dirty) {
+      all |= decl.directive;
+      overrides |= decl.is_override;
+      if (!decl.name.empty()) {
+        names.insert(decl.name);
+      }
+      add(i);
+    }
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    const DocumentDecl &decl = decls[i];
+    if (names.count(decl.name)) {
+      add(i);
+      continue;
+    }
+    for (const std::string &reference : decl.references) {
+      if (names.count(reference)) {
+        add(i);
+        break;
+      }
+    }
+  }
+  // Then everything that depends on those, as its diagnostics may change
+  while (!work.empty()) {
+    uint32_t i = work.back();
+    work.pop_back();
+    for (uint32_t dependent : dependents[i]) {
+      add(dependent);
+    }
+  }
+  // Override ids are checked across all overrides, directives apply to
+  // the whole module, and the errors decide how far resolving gets
+  std::vector<uint8_t> erroring = ErroringDecls(doc);
+  for (uint32_t i = 0; i < count; i++) {
+    if (all || decls[i].directive || erroring[i] ||
+        (overrides && decls[i].is_override)) {
+      subset[i] = 1;
+    }
+  }
+  doc.checked_decls = CheckSubset(doc, subset, dependencies);
+
+  // With different errors, resolving may get to declarations it stopped
+  // short of before
+  if (ErroringDecls(doc) != erroring) {
+    bool unverified = false;
+    for (uint32_t i = 0; i < count; i++) {
+      if (!decls[i].verified && !subset[i]) {
+        unverified = true;
+      }
+    }
+    if (unverified) {
+      for (uint32_t i = 0; i < count; i++) {
+        subset[i] |= !decls[i].verified;
+      }
+      doc.checked_decls += CheckSubset(doc, subset, dependencies);
+    }
+  }
+
+  doc.removed_names.clear();
+  doc.removed_directive = false;
+  doc.removed_override = false;
+  doc.checked = true;
+  LayOutDocumentRecords(doc);
+  return doc.status;
+}
+
+#endif // TINT_WASM_WGSL_TO_SPIRV
+
+// Lays `reflection` out as the TintReflection tables of `ctx`.
+// Returns: The tables, or nullptr if nothing was reflected
+static const TintReflection *ReflectionTable(TintContext &ctx,
+                                             const Reflection &reflection) {
+  if (!reflection.valid) {
+    return nullptr;
+  }
+
+  ctx.reflected_entry_points.clear();
+  for (const auto &entry_point : reflection.entry_points) {
+    TintReflectedEntryPoint row = {};
+    row.name = entry_point.name.c_str();
+    row.stage = entry_point.stage;
+    row.has_workgroup_size = entry_point.has_workgroup_size ? 1 : 0;
+    std::memcpy(row.workgroup_size, entry_point.workgroup_size,
+                sizeof(row.workgroup_size));
+    row.workgroup_storage_size = entry_point.workgroup_storage_size;
+    ctx.reflected_entry_points.push_back(row);
+  }
+  ctx.reflected_overrides.clear();
+  for (const auto &override : reflection.overrides) {
+    ctx.reflected_overrides.push_back(TintReflectedOverride{
+        override.name.c_str(), override.id, override.type, override.flags});
+  }
+  ctx.reflected_vertex_inputs.clear();
+  for (const auto &input : reflection.vertex_inputs) {
+    ctx.reflected_vertex_inputs.push_back(TintReflectedVertexInput{
+        input.entry_point, input.component_type, input.composition,
+        input.location, input.name.c_str()});
+  }
+
+  TintReflection &table = ctx.reflection_table;
+  table.entry_points = ctx.reflected_entry_points.data();
+  table.entry_point_count =
+      static_cast<uint32_t>(ctx.reflected_entry_points.size());
+  table.bindings = reflection.bindings.data();
+  table.binding_count = static_cast<uint32_t>(reflection.bindings.size());
+  table.overrides = ctx.reflected_overrides.data();
+  table.override_count = static_cast<uint32_t>(ctx.reflected_overrides.size());
+  table.vertex_inputs = ctx.reflected_vertex_inputs.data();
+  table.vertex_input_count =
+      static_cast<uint32_t>(ctx.reflected_vertex_inputs.size());
+  return &table;
+}
+
+// Lays `records` out as TintDiagnostic rows in the table of `ctx`.
+// Returns: The table, with its number of rows stored in `count`
+static const TintDiagnostic *
+DiagnosticTable(TintContext &ctx, std::vector<DiagnosticRecord> &records,
+                uint32_t *count) {
+  FlattenDiagnostics(records);
+  ctx.diagnostic_table.clear();
+  for (const DiagnosticRecord &record : records) {
+    TintDiagnostic row = {};
+    row.severity = static_cast<uint8_t>(record.severity);
+    row.line = record.line;
+    row.column = record.column;
+    row.length = record.length;
+    row.file = record.file.c_str();
+    row.message = record.message.c_str();
+    ctx.diagnostic_table.push_back(row);
+  }
+  *count = static_cast<uint32_t>(ctx.diagnostic_table.size());
+  return ctx.diagnostic_table.data();
+}
+
+// Appends `text` to `json` as a quoted JSON string.
+static void AppendJsonString(std::string &json, const std::string &text) {
+  json += '"';
+  for (char c : text) {
+    switch (c) {
+    case '"':
+      json += "\\\"";
+      break;
+    case '\\':
+      json += "\\\\";
+      break;
+    case '\n':
+      json += "\\n";
+      break;
+    case '\t':
+      json += "\\t";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        char escaped[8];
+        snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+        json += escaped;
+      } else {
+        json += c;
+      }
+    }
+  }
+  json += '"';
+}
+
+#if TINT_WASM_WGSL_TO_SPIRV
 
-// SPIRV-Tools
-static spvtools::SpirvTools spirv_tools(SPV_ENV_UNIVERSAL_1_3);
+// Small shader run through Tint by tint_warmup(). It calls a few builtins
+// so that resolving it goes through the intrinsic tables.
+static const char kWarmupShader[] = R"(
+@group(0) @binding(0) var<storage, read_write> data : array<vec4f>;
+@group(0) @binding(1) var<uniform> scale : vec4f;
 
-// Tint
-static tint::spirv::reader::Options tint_spv_reader_options;
-static tint::wgsl::writer::Options tint_wgsl_writer_options;
+@compute @workgroup_size(64)
+fn main(@builtin(global_invocation_id) id : vec3u) {
+  let v = data[id.x];
+  data[id.x] = clamp(sqrt(abs(v)) * scale, vec4f(0.0), vec4f(1.0)) +
+               vec4f(dot(v.xyz, cross(v.xyz, scale.xyz)), length(v), 0.0,
+                     f32(countOneBits(id.x)));
+}
+)";
+
+#endif // TINT_WASM_WGSL_TO_SPIRV
+
+// Stores the outcome of a single shader export `from` -> `to` in the
+// default context, where tint_last_error() picks it up.
+// Returns: true if the conversion succeeded
+static bool RecordLegacyResult(Status status, Format from, Format to,
+                               Conversion &out) {
+  TintContext &ctx = DefaultContext();
+  TintError &error = ctx.last_error;
+  error.status = static_cast<uint32_t>(status);
+  error.from = static_cast<uint8_t>(from);
+  error.to = static_cast<uint8_t>(to);
+  error.reserved = 0;
+  ctx.last_error_diagnostics.clear();
+  ctx.last_records = std::move(out.records);
+  ctx.last_reflection = std::move(out.reflection);
+  error.diagnostics = nullptr;
+  ctx.last_error_unformatted = !ctx.last_records.empty();
+  return status == Status::kSuccess;
+}
+
+// Formats the diagnostics of tint_last_error() if that hasn't happened yet.
+static void FormatLastError(TintContext &ctx) {
+  if (!ctx.last_error_unformatted) {
+    return;
+  }
+  ctx.last_error_unformatted = false;
+  ctx.last_error_diagnostics = DiagnosticText(ctx, ctx.last_records);
+  ctx.last_error.diagnostics = ctx.last_error_diagnostics.empty()
+                                   ? nullptr
+                                   : ctx.last_error_diagnostics.c_str();
+}
+
+// Runs `convert` and reports its output through `out`, as documented for
+// tint_context_convert(): copied into the caller's buffer when out->data is
+// set, otherwise handed over in the buffer it was generated in.
+// Returns: Status, also stored in out->status
+template <typename F>
+static uint32_t ConvertToOutput(TintContext &ctx, Format to, TintOutput *out,
+                                F &&convert) {
+  std::unique_ptr<Conversion> owned;
+  Conversion *conversion = &ctx.convert_scratch;
+  if (!out->data) {
+    owned = std::make_unique<Conversion>();
+    conversion = owned.get();
+  }
+
+  Status status = convert(*conversion);
+  FormatLastError(ctx);
+  ctx.convert_diagnostics = DiagnosticText(ctx, conversion->records);
+  ctx.last_records = std::move(conversion->records);
+  ctx.last_reflection = std::move(conversion->reflection);
+  out->diagnostics = ctx.convert_diagnostics.empty()
+                         ? nullptr
+                         : ctx.convert_diagnostics.c_str();
+
+  const void *result = nullptr;
+  size_t result_size = 0;
+  size_t result_bytes = 0;
+  if (status == Status::kSuccess) {
+    if (to == Format::kSpirv) {
+      result = conversion->spirv.data();
+      result_size = conversion->spirv.size();
+      result_bytes = result_size * sizeof(uint32_t);
+    } else {
+      result = conversion->text.c_str();
+      result_size = conversion->text.size();
+      result_bytes = result_size;
+    }
+  }
+  out->size = static_cast<uint32_t>(result_size);
+
+  if (status == Status::kSuccess) {
+    if (owned) {
+      out->data = const_cast<void *>(result);
+      ctx.owned_outputs.emplace(result, std::move(owned));
+    } else if (result_size > out->capacity) {
+      status = Status::kBufferTooSmall;
+    } else {
+      std::memcpy(out->data, result, result_bytes);
+      // NUL-terminate text outputs when there is room for it
+      if (to != Format::kSpirv && result_size < out->capacity) {
+        static_cast<char *>(out->data)[result_size] = '\0';
+      }
+    }
+  }
+
+  out->status = static_cast<uint32_t>(status);
+  return out->status;
+}
 
 extern "C" {
 
 // Takes a SPIRV binary file and converts it to SPIRV ASM
 // using SPIRV-Tools
-// Returns: C String
+// Returns: C String, or nullptr on failure (see tint_last_error())
 const char *SPV_TO_SPVASM(const uint32_t *spirv, size_t size) {
-  // This automatically disassembles the SPIRV binary file
-  // and stores the generated SPIRV ASM in our static global variable
-  if (!spirv_tools.Disassemble(spirv, size, &spv_asm_gen,
-                               SPV_BINARY_TO_TEXT_OPTION_INDENT | SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES)) {
-    throw std::runtime_error("Failed to disassemble SPIRV");
+  // This disassembles the SPIRV binary file and stores the generated
+  // SPIRV ASM in the default context
+  Conversion out;
+  Status status = CachedConvert(DefaultContext(), Format::kSpirv,
+                                Format::kSpvAsm, spirv, size, out);
+  if (!RecordLegacyResult(status, Format::kSpirv, Format::kSpvAsm, out)) {
+    return nullptr;
   }
 
-  // Convert SPIRV to SPIRV ASM
-  return spv_asm_gen.c_str();
+  DefaultContext().spv_asm_gen = std::move(out.text);
+  return DefaultContext().spv_asm_gen.c_str();
 }
 
 // When called by JS, we will need to prompt the user to download the
 // generated SPIRV binary file. This is because the printed SPIRV binary
 // would just be garbage text when copied and pasted.
-// Returns: C String
+// Returns: Pointer to the SPIRV binary, or nullptr on failure
 const void *SPVASM_TO_SPV(const char *spv_asm, size_t size) {
-  // This automatically assembles the SPIRV ASM file
-  // and stores the generated SPIRV binary in our static global variable
-  if (!spirv_tools.Assemble(spv_asm, size, &spv_bin_gen,
-                            SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS)) {
-    throw std::runtime_error("Failed to assemble SPIRV ASM");
+  // This assembles the SPIRV ASM file and stores the generated
+  // SPIRV binary in the default context
+  Conversion out;
+  Status status = CachedConvert(DefaultContext(), Format::kSpvAsm,
+                                Format::kSpirv, spv_asm, size, out);
+  if (!RecordLegacyResult(status, Format::kSpvAsm, Format::kSpirv, out)) {
+    return nullptr;
   }
 
-  // Convert SPIRV ASM to SPIRV
-  return spv_bin_gen.data();
+  DefaultContext().spv_bin_gen = std::move(out.spirv);
+  return DefaultContext().spv_bin_gen.data();
 }
 
 // Takes a SPIRV binary file and converts it to WGSL
 // using Tint
-// Returns: String
+// Returns: String, or nullptr on failure
 const char *SPV_TO_WGSL(uint32_t *spirv, size_t size) {
+  Conversion out;
+  Status status = CachedConvert(DefaultContext(), Format::kSpirv,
+                                Format::kWgsl, spirv, size, out);
+  if (!RecordLegacyResult(status, Format::kSpirv, Format::kWgsl, out)) {
+    return nullptr;
+  }
 
-  // Parse the SPIRV binary file into an AST
-  std::vector<uint32_t> spirv_binary(spirv, spirv + size);
-  auto program =
-      tint::spirv::reader::Read(spirv_binary, tint_spv_reader_options);
-  if (!program.IsValid()) {
+  // Hand the generated WGSL over to the default context
+  DefaultContext().wgsl_gen = std::move(out.text);
 
-    // Figure out what went wrong by checking the diagnostics
-    tint::diag::List diagnostics = program.Diagnostics();
-    printf("Diagnostics: %s\n", diagnostics.Str().c_str());
+  return DefaultContext().wgsl_gen.c_str();
+}
 
-    std::cerr << "Failed to parse SPIRV file" << std::endl;
+// Returns: String, or nullptr on failure
+const char *SPVASM_TO_WGSL(const char *spv_asm, size_t size) {
+  // Assemble the SPIRV ASM file first
+  Conversion binary;
+  Status status = CachedConvert(DefaultContext(), Format::kSpvAsm,
+                                Format::kSpirv, spv_asm, size, binary);
+  if (!RecordLegacyResult(status, Format::kSpvAsm, Format::kWgsl, binary)) {
     return nullptr;
   }
 
-  // Generate WGSL from the AST
-  auto result = tint::wgsl::writer::Generate(program, tint_wgsl_writer_options);
-  if (result != tint::Success) {
-    std::cerr << "Failed to generate WGSL" << std::endl;
+  Conversion out;
+  status = CachedConvert(DefaultContext(), Format::kSpirv, Format::kWgsl,
+                         binary.spirv.data(), binary.spirv.size(), out);
+  if (!RecordLegacyResult(status, Format::kSpvAsm, Format::kWgsl, out)) {
     return nullptr;
   }
 
-  // Store the generated WGSL code in our static global variable
-  wgsl_gen = result->wgsl;
+  // Hand the generated WGSL over to the default context
+  DefaultContext().wgsl_gen = std::move(out.text);
 
-  return wgsl_gen.c_str();
+  return DefaultContext().wgsl_gen.c_str();
 }
 
-const char *SPVASM_TO_WGSL(const char *spv_asm, size_t size) {
-  // Parse the SPIRV ASM file into an AST
-  std::vector<uint32_t> spirv_binary;
-  if (!spirv_tools.Assemble(spv_asm, size, &spirv_binary,
-                            SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS)) {
-    throw std::runtime_error("Failed to assemble SPIRV ASM");
+// Takes a WGSL file and converts it to SPIRV binary
+// Returns: Pointer to uint32_t SPIRV bin, or nullptr on failure
+const uint32_t *WGSL_TO_SPV(const char *wgsl, size_t size) {
+  // The shell passes the JS string length rather than the UTF-8 byte
+  // length, so this export keeps relying on the NUL terminator.
+  Conversion out;
+  Status status = CachedConvert(DefaultContext(), Format::kWgsl,
+                                Format::kSpirv, wgsl, strlen(wgsl), out);
+  if (!RecordLegacyResult(status, Format::kWgsl, Format::kSpirv, out)) {
+    return nullptr;
   }
 
-  auto program =
-      tint::spirv::reader::Read(spirv_binary, tint_spv_reader_options);
-  if (!program.IsValid()) {
-    // Figure out what went wrong by checking the diagnostics
-    tint::diag::List diagnostics = program.Diagnostics();
-    printf("Diagnostics: %s\n", diagnostics.Str().c_str());
+  // Take ownership of the generated SPIRV binary instead of copying it
+  DefaultContext().spv_bin_gen = std::move(out.spirv);
+
+  return DefaultContext().spv_bin_gen.data();
+}
 
-    std::cerr << "Failed to parse SPIRV file" << std::endl;
+// Takes a WGSL file and converts it to SPIRV ASM
+// Returns: C String pointer, or nullptr on failure
+const char *WGSL_TO_SPVASM(const char *wgsl, size_t size) {
+  // Same as WGSL_TO_SPV, this relies on the NUL terminator
+  Conversion binary;
+  Status status = CachedConvert(DefaultContext(), Format::kWgsl,
+                                Format::kSpirv, wgsl, strlen(wgsl), binary);
+  if (!RecordLegacyResult(status, Format::kWgsl, Format::kSpvAsm, binary)) {
     return nullptr;
   }
 
-  // Generate WGSL from the AST
-  auto result = tint::wgsl::writer::Generate(program, tint_wgsl_writer_options);
-  if (result != tint::Success) {
-    std::cerr << "Failed to generate WGSL" << std::endl;
+  // Disassemble the generated SPIRV binary, keeping the reflection of the
+  // WGSL for tint_reflection()
+  Conversion out;
+  status = CachedConvert(DefaultContext(), Format::kSpirv, Format::kSpvAsm,
+                         binary.spirv.data(), binary.spirv.size(), out);
+  out.reflection = std::move(DefaultContext().last_reflection);
+  if (!RecordLegacyResult(status, Format::kWgsl, Format::kSpvAsm, out)) {
     return nullptr;
   }
 
-  // Store the generated WGSL code in our static global variable
-  wgsl_gen = result->wgsl;
+  DefaultContext().spv_asm_gen = std::move(out.text);
+  return DefaultContext().spv_asm_gen.c_str();
+}
+
+size_t GetSPIRVSize() { return DefaultContext().spv_bin_gen.size(); }
 
-  return wgsl_gen.c_str();
+// Warms up everything the first conversion would otherwise initialize: the
+// default context and its SPIRV-Tools instance, and the code and tables of
+// the WGSL reader, the resolver, the SPIR-V writer and reader, the WGSL
+// writer and the disassembler. Runs on a private context and bypasses the
+// conversion cache, so nothing the caller can observe changes.
+// Returns: Status of the warm-up conversions, kSuccess when all of them ran
+uint32_t tint_warmup() {
+#if TINT_WASM_SPIRV_TEXT
+  DefaultContext().GetSpirvTools();
+#endif
+
+  // The SPIR-V steps start from the SPIR-V of the first one, so a build
+  // without WGSL -> SPIR-V only warms up the SPIRV-Tools instance
+  Status status = Status::kSuccess;
+#if TINT_WASM_WGSL_TO_SPIRV
+  TintContext ctx(kDefaultContextOptions);
+  Conversion spirv;
+  status = Convert(ctx, Format::kWgsl, Format::kSpirv, kWarmupShader,
+                   sizeof(kWarmupShader) - 1, spirv);
+  if (status != Status::kSuccess) {
+    return static_cast<uint32_t>(status);
+  }
+  Conversion out;
+#if TINT_WASM_SPIRV_TO_WGSL
+  status = Convert(ctx, Format::kSpirv, Format::kWgsl, spirv.spirv.data(),
+                   spirv.spirv.size(), out);
+  if (status != Status::kSuccess) {
+    return static_cast<uint32_t>(status);
+  }
+#endif
+#if TINT_WASM_SPIRV_TEXT
+  status = Convert(ctx, Format::kSpirv, Format::kSpvAsm, spirv.spirv.data(),
+                   spirv.spirv.size(), out);
+#endif
+#endif
+  return static_cast<uint32_t>(status);
 }
 
-// Takes a WGSL file and converts it to SPIRV binary
-// Returns: Pointer to uint32_t SPIRV bin
-const uint32_t *WGSL_TO_SPV(const char *wgsl, size_t size) {
+// Returns: The outcome of the last single shader export. Its diagnostics
+//          stay valid until the next single shader export.
+const TintError *tint_last_error() {
+  TintContext &ctx = DefaultContext();
+  FormatLastError(ctx);
+  return &ctx.last_error;
+}
 
-  tint::Source::File source("input.wgsl", wgsl);
+// Converts a whole table of shaders in one call so that JS only crosses
+// the WASM boundary once per batch instead of once per shader.
+// Returns: Pointer to `count` TintBatchResult rows
+const TintBatchResult *tint_context_batch_compile(TintContext *ctx,
+                                                  const TintBatchInput *inputs,
+                                                  uint32_t count) {
+  ctx->batch_results.resize(count);
+  if (ctx->batch_outputs.size() < count) {
+    ctx->batch_outputs.resize(count);
+  }
+  ctx->batch_diagnostics.clear();
 
-  // Parse the WGSL file into an AST
-  auto program =
-      tint::wgsl::reader::Parse(&source, tint::wgsl::reader::Options{});
-  if (!program.IsValid()) {
-    std::cerr << "Failed to parse WGSL file" << std::endl;
-    return nullptr;
+  for (uint32_t i = 0; i < count; i++) {
+    const TintBatchInput &input = inputs[i];
+    TintBatchResult &result = ctx->batch_results[i];
+    Conversion &out = ctx->batch_outputs[i];
+
+    Status status = CachedConvert(*ctx, static_cast<Format>(input.from),
+                                  static_cast<Format>(input.to), input.data,
+                                  input.size, out);
+    FillBatchResult(status, static_cast<Format>(input.to), out, result);
+
+    result.diagnostics =
+        AppendDiagnosticText(*ctx, out.records, ctx->batch_diagnostics);
   }
 
-  // Generate SPIRV from the AST
-  auto result = tint::spirv::writer::Generate(program, {});
-  if (result != tint::Success) {
-    std::cerr << "Failed to generate SPIRV" << std::endl;
+  return ctx->batch_results.data();
+}
+
+// Returns: Base pointer of the diagnostics blob of the last batch
+const char *tint_context_batch_diagnostics(TintContext *ctx) {
+  return ctx->batch_diagnostics.data();
+}
+
+// Converts a single shader and reports the result through `out` rather
+// than through a static global. The input is only read during the call.
+// WGSL is copied into the Tint source file and SPIR-V the Tint reader
+// takes into a word vector; disassembly and assembly read it in place.
+// If `out->data` is set, the output is copied once into that buffer.
+// Otherwise the module hands over the buffer it generated the output in,
+// which the caller releases with tint_context_output_free().
+// Returns: Status (also stored in out->status)
+uint32_t tint_context_convert(TintContext *ctx, uint32_t from, uint32_t to,
+                              const void *data, size_t size,
+                              TintOutput *out) {
+  if (!out) {
+    return static_cast<uint32_t>(Status::kInvalidInput);
+  }
+
+  return ConvertToOutput(*ctx, static_cast<Format>(to), out,
+                         [&](Conversion &conversion) {
+                           return CachedConvert(*ctx, static_cast<Format>(from),
+                                                static_cast<Format>(to), data,
+                                                size, conversion);
+                         });
+}
+
+// Releases an output handed off by tint_context_convert()
+void tint_context_output_free(TintContext *ctx, void *data) {
+  ctx->owned_outputs.erase(data);
+}
+
+// Creates a context with its own options, SPIRV-Tools instance and output
+// storage. Pass nullptr to get the options of the default context.
+// Returns: Pointer to the new context
+TintContext *tint_context_create(const TintContextOptions *options) {
+  return new TintContext(options ? *options : kDefaultContextOptions);
+}
+
+// Destroys a context created with tint_context_create()
+void tint_context_destroy(TintContext *ctx) { delete ctx; }
+
+// Parses and resolves a WGSL shader once, for tint_shader_specialize().
+// On failure `*shader` is set to nullptr and tint_context_diagnostics()
+// tells what went wrong.
+// Returns: Status
+uint32_t tint_context_shader_create(TintContext *ctx, const char *wgsl,
+                                    size_t size, TintShader **shader) {
+  *shader = nullptr;
+  FormatLastError(*ctx);
+  ctx->last_records.clear();
+  ctx->last_reflection = Reflection{};
+  ctx->memory = {};
+  if (!wgsl) {
+    return static_cast<uint32_t>(Status::kInvalidInput);
+  }
+
+#if TINT_WASM_WGSL_TO_SPIRV
+  auto created = std::make_unique<TintShader>();
+  created->ctx = ctx;
+  Murmur3(wgsl, size, 0, created->hash);
+  created->source = std::make_unique<tint::Source::File>(
+      "input.wgsl", std::string_view(wgsl, size));
+  created->program = ParseWgsl(*ctx, *created->source);
+  AccountProgram(*ctx, created->program);
+  if (!created->program.IsValid()) {
+    Conversion out;
+    CaptureDiagnostics(created->program.Diagnostics(), out);
+    ctx->last_records = std::move(out.records);
+    return static_cast<uint32_t>(Status::kParseFailed);
+  }
+
+  Conversion reflected;
+  Reflect(*ctx, created->program, reflected);
+  ctx->last_reflection = std::move(reflected.reflection);
+
+  tint::inspector::Inspector inspector(created->program);
+  created->override_ids = inspector.GetNamedOverrideIds();
+  for (const tint::ast::Function *func : created->program.AST().Functions()) {
+    if (func->IsEntryPoint()) {
+      created->entry_points.push_back(
+          ShaderEntryPoint{func->name->symbol.Name(), func->PipelineStage()});
+    }
+  }
+  *shader = created.release();
+  return static_cast<uint32_t>(Status::kSuccess);
+#else
+  (void)size;
+  return static_cast<uint32_t>(Status::kUnsupported);
+#endif
+}
+
+// Generates `to` (SPIR-V, SPIR-V ASM or WGSL) from a shader created with
+// tint_context_shader_create(), with `count` overrides set to the given
+// values. Only the override substitution and the writer run, the source is
+// not parsed again. The output is reported like tint_context_convert() and
+// owned outputs are released with tint_context_output_free() on the
+// shader's context.
+// Returns: Status (also stored in out->status)
+uint32_t tint_shader_specialize(TintShader *shader, uint32_t to,
+                                const TintOverride *overrides, uint32_t count,
+                                TintOutput *out) {
+  if (!shader || !out || (count && !overrides)) {
+    return static_cast<uint32_t>(Status::kInvalidInput);
+  }
+
+  OverrideValues values;
+  if (!ResolveOverrides(*shader, overrides, count, values)) {
+    out->status = static_cast<uint32_t>(Status::kInvalidInput);
+    return out->status;
+  }
+
+  return ConvertToOutput(*shader->ctx, static_cast<Format>(to), out,
+                         [&](Conversion &conversion) {
+                           return CachedSpecialize(
+                               *shader->ctx, *shader, static_cast<Format>(to),
+                               values, std::string(), conversion);
+                         });
+}
+
+// Generates one module per entry point of a shader, each with everything
+// the entry point doesn't use stripped, and the overrides set like
+// tint_shader_specialize() does. The shader is not parsed again.
+// Returns: One TintEntryPointResult row per entry point, with the number of
+//          rows stored in `rows`, or nullptr if an override is unknown
+const TintEntryPointResult *tint_shader_split(TintShader *shader, uint32_t to,
+                                              const TintOverride *overrides,
+                                              uint32_t count, uint32_t flags,
+                                              uint32_t *rows) {
+  *rows = 0;
+  OverrideValues values;
+  if (!shader || (count && !overrides) ||
+      !ResolveOverrides(*shader, overrides, count, values)) {
     return nullptr;
   }
 
-  // Resize the vector to store the generated SPIRV binary
-  spv_bin_gen.resize(result->spirv.size());
+  SplitEntryPoints(*shader, static_cast<Format>(to), values,
+                   (flags & kTintSplitParallel) != 0);
+  *rows = static_cast<uint32_t>(shader->split_results.size());
+  return shader->split_results.data();
+}
+
+// Returns: Base pointer of the diagnostics blob of the last split
+const char *tint_shader_split_diagnostics(TintShader *shader) {
+  return shader->split_diagnostics.data();
+}
+
+// Releases a shader created with tint_context_shader_create()
+void tint_shader_destroy(TintShader *shader) { delete shader; }
+
+// Creates a document holding `size` bytes of WGSL, to be kept in sync with
+// an editor through tint_document_edit(). Nothing is parsed or resolved
+// until the first tint_document_check().
+// Returns: Status
+uint32_t tint_context_document_create(TintContext *ctx, const char *wgsl,
+                                      size_t size, TintDocument **doc) {
+  *doc = nullptr;
+  if (!wgsl && size) {
+    return static_cast<uint32_t>(Status::kInvalidInput);
+  }
+
+#if TINT_WASM_WGSL_TO_SPIRV
+  auto created = std::make_unique<TintDocument>();
+  created->ctx = ctx;
+  EditDocument(*created, 0, 0, std::string_view(wgsl, size));
+  created->relexed_bytes = 0;
+  *doc = created.release();
+  return static_cast<uint32_t>(Status::kSuccess);
+#else
+  (void)ctx;
+  return static_cast<uint32_t>(Status::kUnsupported);
+#endif
+}
 
-  // Store the generated SPIRV binary in our static global variable
-  std::memcpy(spv_bin_gen.data(), result->spirv.data(),
-              result->spirv.size() * sizeof(uint32_t));
+// Same as above, on the default context.
+uint32_t tint_document_create(const char *wgsl, size_t size,
+                              TintDocument **doc) {
+  return tint_context_document_create(&DefaultContext(), wgsl, size, doc);
+}
 
-  return spv_bin_gen.data();
+// Replaces the bytes [begin, end) of a document with `size` bytes of
+// `text`. Only the declarations around the edit are lexed again.
+// Returns: Status
+uint32_t tint_document_edit(TintDocument *doc, uint32_t begin, uint32_t end,
+                            const char *text, size_t size) {
+  if (!doc || begin > end || end > doc->text.size() || (!text && size)) {
+    return static_cast<uint32_t>(Status::kInvalidInput);
+  }
+#if TINT_WASM_WGSL_TO_SPIRV
+  EditDocument(*doc, begin, end, std::string_view(text, size));
+  return static_cast<uint32_t>(Status::kSuccess);
+#else
+  return static_cast<uint32_t>(Status::kUnsupported);
+#endif
 }
 
-// Takes a WGSL file and converts it to SPIRV ASM
-// Returns: C String pointer
-const char *WGSL_TO_SPVASM(const char *wgsl, size_t size) {
+// Brings the diagnostics of a document up to date with its text, parsing
+// and resolving only the declarations the edits since the last check can
+// have affected.
+// Returns: kSuccess, or kParseFailed if the document has errors
+uint32_t tint_document_check(TintDocument *doc) {
+  if (!doc) {
+    return static_cast<uint32_t>(Status::kInvalidInput);
+  }
+#if TINT_WASM_WGSL_TO_SPIRV
+  doc->checked_relexed_bytes = doc->relexed_bytes;
+  doc->relexed_bytes = 0;
+  return static_cast<uint32_t>(CheckDocument(*doc));
+#else
+  return static_cast<uint32_t>(Status::kUnsupported);
+#endif
+}
 
-  tint::Source::File source("input.wgsl", wgsl);
+// Returns: The diagnostic records of the last tint_document_check(), in
+//          the table of the document's context
+const TintDiagnostic *tint_document_diagnostics(TintDocument *doc,
+                                                uint32_t *count) {
+  return DiagnosticTable(*doc->ctx, doc->records, count);
+}
 
-  // Parse the WGSL file into an AST
-  auto program =
-      tint::wgsl::reader::Parse(&source, tint::wgsl::reader::Options{});
-  if (!program.IsValid()) {
-    std::cerr << "Failed to parse WGSL file" << std::endl;
+// Fills in the declaration counts of the last tint_document_check()
+void tint_document_stats(TintDocument *doc, TintDocumentStats *stats) {
+  *stats = {};
+  stats->declarations = static_cast<uint32_t>(doc->decls.size());
+  stats->checked_declarations = doc->checked_decls;
+  stats->relexed_bytes = doc->checked_relexed_bytes;
+  stats->text_bytes = static_cast<uint32_t>(doc->text.size());
+}
+
+// Releases a document created with tint_context_document_create()
+void tint_document_destroy(TintDocument *doc) { delete doc; }
+
+// The context-less exports below run on the default context.
+const TintBatchResult *tint_batch_compile(const TintBatchInput *inputs,
+                                          uint32_t count) {
+  return tint_context_batch_compile(&DefaultContext(), inputs, count);
+}
+
+const char *tint_batch_diagnostics() {
+  return tint_context_batch_diagnostics(&DefaultContext());
+}
+
+uint32_t tint_convert(uint32_t from, uint32_t to, const void *data,
+                      size_t size, TintOutput *out) {
+  return tint_context_convert(&DefaultContext(), from, to, data, size, out);
+}
+
+void tint_output_free(void *data) {
+  tint_context_output_free(&DefaultContext(), data);
+#if TINT_WASM_THREADS
+  tint_context_output_free(&RequestContext(), data);
+#endif
+}
+
+uint32_t tint_shader_create(const char *wgsl, size_t size,
+                            TintShader **shader) {
+  return tint_context_shader_create(&DefaultContext(), wgsl, size, shader);
+}
+
+// Sets the memory budget of the conversion cache in bytes, evicting the
+// least recently used entries if it shrinks. A budget of 0 disables it.
+void tint_cache_set_budget(uint32_t bytes) {
+  conversion_cache.SetBudget(bytes);
+}
+
+// Drops every cached conversion. The hit/miss counters are kept.
+void tint_cache_clear() { conversion_cache.Clear(); }
+
+// Copies the cache counters into `stats`
+void tint_cache_stats(TintCacheStats *stats) {
+  *stats = conversion_cache.Stats();
+}
+
+// Turns profiling on or off for a context. Collected numbers are kept
+// until tint_context_profile_reset().
+void tint_context_set_profiling(TintContext *ctx, uint32_t flags) {
+  ctx->profiler.flags = flags;
+}
+
+void tint_context_profile_reset(TintContext *ctx) { ctx->profiler.Reset(); }
+
+// Returns: The per-phase table of the context, `count` rows long
+const TintPhaseStats *tint_context_phase_stats(TintContext *ctx,
+                                               uint32_t *count) {
+  *count = static_cast<uint32_t>(Phase::kCount);
+  return ctx->profiler.Stats();
+}
+
+// Returns: Chrome trace-event JSON of the recorded phases
+const char *tint_context_trace(TintContext *ctx) {
+  return ctx->profiler.Trace();
+}
+
+void tint_set_profiling(uint32_t flags) {
+  tint_context_set_profiling(&DefaultContext(), flags);
+}
+
+void tint_profile_reset() { tint_context_profile_reset(&DefaultContext()); }
+
+const TintPhaseStats *tint_phase_stats(uint32_t *count) {
+  return tint_context_phase_stats(&DefaultContext(), count);
+}
+
+const char *tint_trace() { return tint_context_trace(&DefaultContext()); }
+
+// Copies the memory statistics of the last conversion on `ctx`
+void tint_context_memory_stats(TintContext *ctx, TintMemoryStats *stats) {
+  *stats = ctx->memory;
+}
+
+void tint_memory_stats(TintMemoryStats *stats) {
+  tint_context_memory_stats(&DefaultContext(), stats);
+}
+
+// Returns: The diagnostic records of the last single conversion on `ctx`
+const TintDiagnostic *tint_context_diagnostics(TintContext *ctx,
+                                               uint32_t *count) {
+  return DiagnosticTable(*ctx, ctx->last_records, count);
+}
+
+// Returns: The diagnostic records of row `index` of the last batch
+const TintDiagnostic *tint_context_batch_diagnostic_records(TintContext *ctx,
+                                                            uint32_t index,
+                                                            uint32_t *count) {
+  if (index >= ctx->batch_results.size()) {
+    *count = 0;
     return nullptr;
   }
+  return DiagnosticTable(*ctx, ctx->batch_outputs[index].records, count);
+}
 
-  // Generate SPIRV from the AST
-  auto result = tint::spirv::writer::Generate(program, {});
-  if (result != tint::Success) {
-    std::cerr << "Failed to generate SPIRV" << std::endl;
+// Returns: The records of tint_context_diagnostics() as a JSON array
+const char *tint_context_diagnostics_json(TintContext *ctx) {
+  FlattenDiagnostics(ctx->last_records);
+  std::string &json = ctx->diagnostic_json;
+  json = "[";
+  char location[96];
+  for (const DiagnosticRecord &record : ctx->last_records) {
+    if (json.size() > 1) {
+      json += ',';
+    }
+    json += "{\"severity\":\"";
+    json += kSeverityNames[static_cast<size_t>(record.severity)];
+    json += "\",\"file\":";
+    AppendJsonString(json, record.file);
+    snprintf(location, sizeof(location),
+             ",\"line\":%u,\"column\":%u,\"length\":%u,\"message\":",
+             record.line, record.column, record.length);
+    json += location;
+    AppendJsonString(json, record.message);
+    json += '}';
+  }
+  json += "]";
+  return json.c_str();
+}
+
+// Formatting diagnostics as text is on by default, for tint_last_error()
+// and the other exports that report them as C strings
+void tint_context_set_diagnostic_text(TintContext *ctx, uint32_t enabled) {
+  ctx->diagnostic_text = enabled != 0;
+}
+
+const TintDiagnostic *tint_diagnostics(uint32_t *count) {
+  return tint_context_diagnostics(&DefaultContext(), count);
+}
+
+const TintDiagnostic *tint_batch_diagnostic_records(uint32_t index,
+                                                    uint32_t *count) {
+  return tint_context_batch_diagnostic_records(&DefaultContext(), index, count);
+}
+
+const char *tint_diagnostics_json() {
+  return tint_context_diagnostics_json(&DefaultContext());
+}
+
+void tint_set_diagnostic_text(uint32_t enabled) {
+  tint_context_set_diagnostic_text(&DefaultContext(), enabled);
+}
+
+// Turns reflection of the resolved program on or off for a context. It is
+// off by default.
+void tint_context_set_reflection(TintContext *ctx, uint32_t enabled) {
+  ctx->reflect = enabled != 0;
+}
+
+// Returns: The reflection of the last single conversion on `ctx`, or
+//          nullptr if it didn't reflect anything
+const TintReflection *tint_context_reflection(TintContext *ctx) {
+  return ReflectionTable(*ctx, ctx->last_reflection);
+}
+
+// Returns: The reflection of row `index` of the last batch
+const TintReflection *tint_context_batch_reflection(TintContext *ctx,
+                                                    uint32_t index) {
+  if (index >= ctx->batch_results.size()) {
     return nullptr;
   }
+  return ReflectionTable(*ctx, ctx->batch_outputs[index].reflection);
+}
+
+void tint_set_reflection(uint32_t enabled) {
+  tint_context_set_reflection(&DefaultContext(), enabled);
+}
+
+const TintReflection *tint_reflection() {
+  return tint_context_reflection(&DefaultContext());
+}
 
-  // Disassemble the generated SPIRV binary
-  if (!spirv_tools.Disassemble(result->spirv.data(), result->spirv.size(),
-                               &spv_asm_gen, SPV_BINARY_TO_TEXT_OPTION_INDENT | SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES)) {
-    throw std::runtime_error("Failed to disassemble SPIRV");
+const TintReflection *tint_batch_reflection(uint32_t index) {
+  return tint_context_batch_reflection(&DefaultContext(), index);
+}
+
+// Sets up the SPIR-V optimizer of a context. The optimizer and its pass
+// list are built here once, and reused by every conversion afterwards.
+// Returns: kSuccess, or kInvalidInput (optimizer off) for an unknown mode
+//          or flag
+uint32_t tint_context_set_optimizer(TintContext *ctx, uint32_t mode,
+                                    const char *flags) {
+  bool valid = SetOptimizer(*ctx, static_cast<OptimizeMode>(mode),
+                            flags ? flags : "");
+  if (!valid) {
+    SetOptimizer(*ctx, OptimizeMode::kNone, "");
   }
+  return static_cast<uint32_t>(valid ? Status::kSuccess
+                                     : Status::kInvalidInput);
+}
 
-  return spv_asm_gen.c_str();
+// Copies the word counts of the optimizer runs on `ctx` into `stats`
+void tint_context_optimizer_stats(TintContext *ctx, TintOptimizerStats *stats) {
+  *stats = ctx->optimizer_stats;
 }
 
-size_t GetSPIRVSize() {
-  printf("SPIRV SIZE: %zu\n", spv_bin_gen.size());
-  return spv_bin_gen.size();
+uint32_t tint_set_optimizer(uint32_t mode, const char *flags) {
+  return tint_context_set_optimizer(&DefaultContext(), mode, flags);
 }
-} // extern "C"
 
-/*// Attempt to re-parse the output program with Tint's WGSL reader.*/
-/*tint::wgsl::reader::Options parser_options;*/
-/*parser_options.allowed_features = tint::wgsl::AllowedFeatures::Everything();*/
-/*auto source =*/
-/*    std::make_unique<tint::Source::File>("output.wgsl", result->wgsl);*/
-/*auto reparsed_program =*/
-/*    tint::wgsl::reader::Parse(source.get(), parser_options);*/
-/*if (!reparsed_program.IsValid()) {*/
-/*  std::cerr << "Failed to re-parse generated WGSL: " << std::endl;*/
-/*} else {*/
-/*  std::cout << "Successfully re-parsed generated WGSL" << std::endl;*/
-/*}*/
-/**/
-/*// Print the binding information from the re-parsed program.*/
-/*tint::inspector::Inspector inspector(reparsed_program);*/
-/*/*auto bindings = inspector.GetEntryPoint*/
+void tint_optimizer_stats(TintOptimizerStats *stats) {
+  tint_context_optimizer_stats(&DefaultContext(), stats);
+}
+
+#if TINT_WASM_THREADS
+
+// Queues a batch on the worker pool and returns straight away. The input
+// table is copied, but the shader data it points at must stay alive until
+// the job completes.
+// Returns: Job handle, released with tint_job_release()
+TintJob *tint_batch_compile_async(const TintBatchInput *inputs,
+                                  uint32_t count, TintJobCallback callback,
+                                  void *user_data) {
+  auto *job = new TintJob;
+  job->inputs.assign(inputs, inputs + count);
+  job->results.resize(count);
+  job->outputs.resize(count);
+  job->callback = callback;
+  job->user_data = user_data;
+  job->settings = SettingsOf(DefaultContext());
+  job->remaining = count;
+
+  if (count == 0) {
+    WorkerPool::Done(job);
+    return job;
+  }
+
+  Workers().Submit(job);
+  return job;
+}
+
+// Returns: 1 once every shader of the job is converted, otherwise 0
+uint32_t tint_job_done(TintJob *job) { return job->done ? 1 : 0; }
+
+// Blocks until the job is done. Browsers don't allow blocking the main
+// thread, so only call this from a worker.
+void tint_job_wait(TintJob *job) {
+  std::unique_lock<std::mutex> lock(job->mutex);
+  job->finished.wait(lock, [job] { return job->done.load(); });
+}
+
+// Returns: The result rows of a finished job, or nullptr while it runs
+const TintBatchResult *tint_job_results(TintJob *job) {
+  return job->done ? job->results.data() : nullptr;
+}
+
+// Returns: Base pointer of the diagnostics blob of a finished job
+const char *tint_job_diagnostics(TintJob *job) {
+  return job->done ? job->diagnostics.data() : nullptr;
+}
+
+// Releases a finished job along with all of its outputs
+void tint_job_release(TintJob *job) {
+  if (!job || !job->done) {
+    return;
+  }
+  {
+    // Also waits for the finishing worker to let go of the job
+    std::lock_guard<std::mutex> lock(job->mutex);
+    if (job->callback_pending) {
+      // Deleted once the callback has run, see RunJobCallback()
+      job->released = true;
+      return;
+    }
+  }
+  delete job;
+}
+
+// Queues one conversion on the worker pool under a caller chosen id and
+// returns straight away. The input is copied.
+// Returns: kSuccess once queued, kInvalidInput if `data` is null or the id
+//          belongs to a request that wasn't finished yet
+uint32_t tint_convert_async(uint32_t request_id, uint32_t from, uint32_t to,
+                            const void *data, size_t size,
+                            TintRequestCallback callback, void *user_data) {
+  if (!data) {
+    return static_cast<uint32_t>(Status::kInvalidInput);
+  }
+
+  auto request = std::make_shared<AsyncRequest>();
+  request->id = request_id;
+  request->from = static_cast<Format>(from);
+  request->to = static_cast<Format>(to);
+  request->size = size;
+  size_t bytes = request->from == Format::kSpirv ? size * sizeof(uint32_t)
+                                                 : size;
+  request->input.resize((bytes + sizeof(uint32_t) - 1) / sizeof(uint32_t));
+  std::memcpy(request->input.data(), data, bytes);
+  request->callback = callback;
+  request->user_data = user_data;
+  request->settings = SettingsOf(DefaultContext());
+
+  {
+    AsyncRequests &registry = Requests();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    if (!registry.requests.emplace(request_id, request).second) {
+      return static_cast<uint32_t>(Status::kInvalidInput);
+    }
+  }
+  Workers().Submit(std::move(request));
+  return static_cast<uint32_t>(Status::kSuccess);
+}
+
+// Returns: kTintRequestPending while the request is queued or running, its
+//          Status once it completed, or kInvalidInput for an unknown id
+uint32_t tint_request_status(uint32_t request_id) {
+  AsyncRequests &registry = Requests();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto it = registry.requests.find(request_id);
+  if (it == registry.requests.end()) {
+    return static_cast<uint32_t>(Status::kInvalidInput);
+  }
+  return it->second->status;
+}
+
+// Cancels a request. One that is still queued completes right away, one
+// that is running stops at the next stage of its conversion. Either way
+// it completes with kCancelled and its callback runs.
+// Returns: 1 if the request is going to complete as kCancelled, 0 if it
+//          already completed or the id is unknown
+uint32_t tint_request_cancel(uint32_t request_id) {
+  std::shared_ptr<AsyncRequest> request;
+  {
+    AsyncRequests &registry = Requests();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto it = registry.requests.find(request_id);
+    if (it == registry.requests.end() ||
+        it->second->status != kTintRequestPending) {
+      return 0;
+    }
+    request = it->second;
+    request->cancel = true;
+    if (request->started) {
+      return 1;
+    }
+    // Still queued: complete it under the lock, so that neither a second
+    // cancel nor the worker that dequeues it can complete it again
+    request->status = static_cast<uint32_t>(Status::kCancelled);
+  }
+  WorkerPool::Notify(*request, Status::kCancelled);
+  return 1;
+}
+
+// Hands the output of a completed request to the caller and frees its id.
+// `out` works like it does for tint_convert(), and out->diagnostics stays
+// valid until the next tint_request_result().
+// Returns: kTintRequestPending (leaving the request alone) while it runs,
+//          otherwise its Status, also stored in out->status
+uint32_t tint_request_result(uint32_t request_id, TintOutput *out) {
+  std::shared_ptr<AsyncRequest> request;
+  {
+    AsyncRequests &registry = Requests();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto it = registry.requests.find(request_id);
+    if (it == registry.requests.end()) {
+      out->status = static_cast<uint32_t>(Status::kInvalidInput);
+      return out->status;
+    }
+    if (it->second->status == kTintRequestPending) {
+      return kTintRequestPending;
+    }
+    request = std::move(it->second);
+    registry.requests.erase(it);
+  }
+
+  TintContext &ctx = RequestContext();
+  ctx.diagnostic_text = request->settings->diagnostic_text;
+  return ConvertToOutput(ctx, request->to, out, [&](Conversion &conversion) {
+    conversion = std::move(request->out);
+    return static_cast<Status>(request->status);
+  });
+}
+
+#endif // TINT_WASM_THREADS
+} // extern "C"
@@ -0,0 +1,764 @@
+// File: tint_wasm.h
+// Author: Kyle Lukaszek
+// Email: kylelukaszek [at] gmail [dot] com
+// Date: 2024-09-21
+// -------------------------------------------------------------
+//
+// License: Apache 2.0 (Follows the same license as Tint)
+//
+// Description: Public interface of the tint_wasm.cpp module.
+//
+//              Everything declared in the extern "C" block below
+//              is exported from the WASM module (see the Makefile),
+//              so the layout of every struct in this file is part
+//              of the JS-facing ABI. Field offsets are given for
+//              wasm32, where pointers are 4 bytes wide. Read them
+//              from JS with HEAPU8 / HEAPU32 at those offsets.
+//
+//              Sizes follow the same convention as the original
+//              single-shader exports: SPIR-V binaries are measured
+//              in 32-bit words, everything else in bytes.
+//
+// ---------------------------------------------------------------
+
+#ifndef TINT_WASM_H_
+#define TINT_WASM_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// Shader formats understood by the module. Values are stable and
+// are what JS passes in the `from` / `to` fields of the batch table.
+// kIrBin is an encoded, already resolved core IR module. It can be
+// produced from and converted to every other format, but only in builds
+// with TINT_BUILD_IR_BINARY. Everywhere else it reports kUnsupported.
+enum class Format : uint8_t {
+  kUnknown,
+  kNone,
+  kSpirv,
+  kSpvAsm,
+  kWgsl,
+  kIr,
+  kIrBin
+};
+
+// SPIR-V optimization applied after Tint generates a module, see
+// tint_context_set_optimizer(). kCustom runs a list of spirv-opt flags.
+enum class OptimizeMode : uint32_t {
+  kNone,
+  kPerformance,
+  kSize,
+  kCustom,
+};
+
+// Result of a single conversion.
+enum class Status : uint32_t {
+  kSuccess,
+  // The input pointer was null or the format pair is malformed
+  kInvalidInput,
+  // There is no conversion from `from` to `to`
+  kUnsupported,
+  // The input could not be parsed (SPIR-V, SPIR-V ASM or WGSL)
+  kParseFailed,
+  // The input parsed, but the output could not be generated
+  kGenerateFailed,
+  // The caller provided output buffer cannot hold the output
+  kBufferTooSmall,
+  // The IR blob was encoded by a different build of the module
+  kStaleIrBlob,
+  // The request was cancelled with tint_request_cancel()
+  kCancelled,
+};
+
+// One row of the packed input table passed to tint_batch_compile().
+// wasm32 layout (12 bytes):
+//   +0  u8   from
+//   +1  u8   to
+//   +2  u16  reserved, must be 0
+//   +4  u32  size
+//   +8  ptr  data
+struct TintBatchInput {
+  uint8_t from;
+  uint8_t to;
+  uint16_t reserved;
+  uint32_t size;
+  const void *data;
+};
+
+// One row of the packed result table returned by tint_batch_compile().
+// wasm32 layout (16 bytes):
+//   +0  u32  status
+//   +4  u32  size
+//   +8  ptr  output (nullptr on failure)
+//   +12 u32  diagnostics offset into tint_batch_diagnostics(),
+//            or kTintNoDiagnostics
+struct TintBatchResult {
+  uint32_t status;
+  uint32_t size;
+  const void *output;
+  uint32_t diagnostics;
+};
+
+// Result descriptor filled in by tint_convert().
+// wasm32 layout (20 bytes):
+//   +0  u32  status
+//   +4  u32  size         output size
+//   +8  ptr  data         in:  caller buffer, or nullptr to take ownership
+//                         out: the output
+//   +12 u32  capacity     in:  capacity of the caller buffer, in the same
+//                              unit as `size`
+//   +16 ptr  diagnostics  C string, or nullptr when there were none
+struct TintOutput {
+  uint32_t status;
+  uint32_t size;
+  void *data;
+  uint32_t capacity;
+  const char *diagnostics;
+};
+
+// Options for tint_context_create().
+// wasm32 layout (8 bytes):
+//   +0  u32  spirv_env                      spv_target_env for SPIRV-Tools
+//   +4  u8   allow_non_uniform_derivatives  SPIR-V reader
+//   +5  u8   disable_robustness             SPIR-V writer
+//   +6  u8   disable_workgroup_init         SPIR-V writer
+//   +7  u8   use_ir                         convert over core IR only
+struct TintContextOptions {
+  uint32_t spirv_env;
+  uint8_t allow_non_uniform_derivatives;
+  uint8_t disable_robustness;
+  uint8_t disable_workgroup_init;
+  uint8_t use_ir;
+};
+
+// Counters of the conversion cache, see tint_cache_stats().
+// wasm32 layout (24 bytes):
+//   +0  u32  hits
+//   +4  u32  misses
+//   +8  u32  evictions
+//   +12 u32  entries  number of cached conversions
+//   +16 u32  bytes    memory used by the cached conversions
+//   +20 u32  budget   memory budget, 0 when the cache is disabled
+struct TintCacheStats {
+  uint32_t hits;
+  uint32_t misses;
+  uint32_t evictions;
+  uint32_t entries;
+  uint32_t bytes;
+  uint32_t budget;
+};
+
+// Work done by the last tint_document_check(), see tint_document_stats().
+// wasm32 layout (16 bytes):
+//   +0  u32  declarations          top-level declarations and directives
+//   +4  u32  checked_declarations  the ones parsed and resolved again
+//   +8  u32  relexed_bytes         text lexed again by the edits before it
+//   +12 u32  text_bytes            size of the document
+struct TintDocumentStats {
+  uint32_t declarations;
+  uint32_t checked_declarations;
+  uint32_t relexed_bytes;
+  uint32_t text_bytes;
+};
+
+// Bits of tint_context_set_profiling().
+// kTintProfileStats  accumulate wall time and call counts per phase
+// kTintProfileTrace  also record every phase as a Chrome trace event
+constexpr uint32_t kTintProfileStats = 1u;
+constexpr uint32_t kTintProfileTrace = 2u;
+
+// One row of the table returned by tint_context_phase_stats().
+// wasm32 layout (24 bytes):
+//   +0  ptr  name      C string, e.g. "wgsl.parse"
+//   +4  u32  calls
+//   +8  f64  total_us  wall time summed over every call
+//   +16 f64  max_us    slowest single call
+struct TintPhaseStats {
+  const char *name;
+  uint32_t calls;
+  double total_us;
+  double max_us;
+};
+
+// Heap memory held by one group of Tint allocators, see TintMemoryStats.
+// wasm32 layout (12 bytes):
+//   +0  u32  objects  objects (or allocations) made from the allocators
+//   +4  u32  blocks   heap blocks backing them
+//   +8  u32  bytes    bytes of those heap blocks
+struct TintAllocatorStats {
+  uint32_t objects;
+  uint32_t blocks;
+  uint32_t bytes;
+};
+
+// Memory used by the Tint data structures of the last conversion on a
+// context, see tint_context_memory_stats().
+// wasm32 layout (52 bytes):
+//   +0  TintAllocatorStats  program     AST and semantic nodes, symbols
+//   +12 TintAllocatorStats  ir          IR blocks, instructions, values,
+//                                       symbols
+//   +24 TintAllocatorStats  types       type::Manager
+//   +36 TintAllocatorStats  constants   constant::Manager
+//   +48 u32                 peak_bytes  sum of the bytes above
+struct TintMemoryStats {
+  TintAllocatorStats program;
+  TintAllocatorStats ir;
+  TintAllocatorStats types;
+  TintAllocatorStats constants;
+  uint32_t peak_bytes;
+};
+
+// Outcome of the last single shader export, see tint_last_error().
+// wasm32 layout (12 bytes):
+//   +0  u32  status       kSuccess if the export returned its output
+//   +4  u8   from         formats of the export, e.g. kSpvAsm -> kWgsl for
+//   +5  u8   to           SPVASM_TO_WGSL, even if only one step failed
+//   +6  u16  reserved
+//   +8  ptr  diagnostics  C string, or nullptr when there were none
+struct TintError {
+  uint32_t status;
+  uint8_t from;
+  uint8_t to;
+  uint16_t reserved;
+  const char *diagnostics;
+};
+
+// Severity of a TintDiagnostic, in the same order as tint::diag::Severity.
+enum class Severity : uint8_t { kNote, kWarning, kError };
+
+// One structured diagnostic, see tint_context_diagnostics().
+// wasm32 layout (24 bytes):
+//   +0  u8   severity  Severity
+//   +1  u8   reserved[3]
+//   +4  u32  line      1-based, 0 when the message has no location
+//   +8  u32  column    1-based, in bytes
+//   +12 u32  length    length of the source range, in code points
+//   +16 ptr  file      C string, e.g. "input.wgsl", empty when unknown
+//   +20 ptr  message   C string, the bare message without the location
+struct TintDiagnostic {
+  uint8_t severity;
+  uint8_t reserved[3];
+  uint32_t line;
+  uint32_t column;
+  uint32_t length;
+  const char *file;
+  const char *message;
+};
+
+// One override value passed to tint_shader_specialize().
+// wasm32 layout (16 bytes):
+//   +0  ptr  name   C string naming the override, or nullptr to use `id`
+//   +4  u32  id     @id of the override, or the id Tint gave it
+//   +8  f64  value  converted to the type of the override
+struct TintOverride {
+  const char *name;
+  uint32_t id;
+  double value;
+};
+
+// One row of the table returned by tint_shader_split().
+// wasm32 layout (24 bytes):
+//   +0  ptr              name    C string, name of the entry point
+//   +4  u32              stage   0 vertex, 1 fragment, 2 compute
+//   +8  TintBatchResult  result  same as a batch row, with the diagnostics
+//                                offset into tint_shader_split_diagnostics()
+struct TintEntryPointResult {
+  const char *name;
+  uint32_t stage;
+  TintBatchResult result;
+};
+
+// Bits of tint_shader_split().
+// kTintSplitParallel  generate the entry points on the compile workers.
+//                     Only honoured by the threaded build (make threads).
+constexpr uint32_t kTintSplitParallel = 1u;
+
+// Reflection of one entry point, see TintReflection.
+// wasm32 layout (24 bytes):
+//   +0  ptr  name                    C string
+//   +4  u8   stage                   0 vertex, 1 fragment, 2 compute
+//   +5  u8   has_workgroup_size      0 if the size depends on overrides or
+//                                    the entry point is not a compute shader
+//   +6  u16  reserved
+//   +8  u32  workgroup_size[3]
+//   +20 u32  workgroup_storage_size  bytes of workgroup memory used
+struct TintReflectedEntryPoint {
+  const char *name;
+  uint8_t stage;
+  uint8_t has_workgroup_size;
+  uint16_t reserved;
+  uint32_t workgroup_size[3];
+  uint32_t workgroup_storage_size;
+};
+
+// One resource binding used by an entry point, see TintReflection. The
+// enums are the ones of tint::inspector::ResourceBinding.
+// wasm32 layout (20 bytes):
+//   +0  u16  entry_point    index into TintReflection::entry_points
+//   +2  u8   resource_type  ResourceBinding::ResourceType
+//   +3  u8   dimension      ResourceBinding::TextureDimension
+//   +4  u32  group
+//   +8  u32  binding
+//   +12 u8   sampled_kind   ResourceBinding::SampledKind
+//   +13 u8   texel_format   ResourceBinding::TexelFormat
+//   +14 u16  reserved
+//   +16 u32  size           minimum buffer size in bytes, 0 for others
+struct TintReflectedBinding {
+  uint16_t entry_point;
+  uint8_t resource_type;
+  uint8_t dimension;
+  uint32_t group;
+  uint32_t binding;
+  uint8_t sampled_kind;
+  uint8_t texel_format;
+  uint16_t reserved;
+  uint32_t size;
+};
+
+// Bits of TintReflectedOverride::flags.
+constexpr uint8_t kTintOverrideInitialized = 1u;
+constexpr uint8_t kTintOverrideIdSpecified = 2u;
+
+// One override used by the entry points, see TintReflection.
+// wasm32 layout (8 bytes):
+//   +0  ptr  name   C string
+//   +4  u16  id     the id tint_shader_specialize() takes
+//   +6  u8   type   0 bool, 1 f32, 2 u32, 3 i32, 4 f16
+//   +7  u8   flags  kTintOverrideInitialized | kTintOverrideIdSpecified
+struct TintReflectedOverride {
+  const char *name;
+  uint16_t id;
+  uint8_t type;
+  uint8_t flags;
+};
+
+// One vertex shader input with a @location, see TintReflection.
+// wasm32 layout (12 bytes):
+//   +0  u16  entry_point     index into TintReflection::entry_points
+//   +2  u8   component_type  0 f32, 1 u32, 2 i32, 3 f16
+//   +3  u8   composition     0 scalar, 1 vec2, 2 vec3, 3 vec4
+//   +4  u32  location
+//   +8  ptr  name            C string
+struct TintReflectedVertexInput {
+  uint16_t entry_point;
+  uint8_t component_type;
+  uint8_t composition;
+  uint32_t location;
+  const char *name;
+};
+
+// Reflection of the program a conversion resolved, see
+// tint_context_reflection().
+// wasm32 layout (32 bytes):
+//   +0  ptr  entry_points        TintReflectedEntryPoint rows
+//   +4  u32  entry_point_count
+//   +8  ptr  bindings            TintReflectedBinding rows
+//   +12 u32  binding_count
+//   +16 ptr  overrides           TintReflectedOverride rows
+//   +20 u32  override_count
+//   +24 ptr  vertex_inputs       TintReflectedVertexInput rows
+//   +28 u32  vertex_input_count
+struct TintReflection {
+  const TintReflectedEntryPoint *entry_points;
+  uint32_t entry_point_count;
+  const TintReflectedBinding *bindings;
+  uint32_t binding_count;
+  const TintReflectedOverride *overrides;
+  uint32_t override_count;
+  const TintReflectedVertexInput *vertex_inputs;
+  uint32_t vertex_input_count;
+};
+
+// Module sizes before and after the SPIR-V optimizer, see
+// tint_context_optimizer_stats().
+// wasm32 layout (20 bytes):
+//   +0  u32  runs             optimizer runs since the context was created
+//   +4  u32  last_words_in    words of the last module, before
+//   +8  u32  last_words_out   and after optimizing it
+//   +12 u32  total_words_in   the same, summed over every run
+//   +16 u32  total_words_out
+struct TintOptimizerStats {
+  uint32_t runs;
+  uint32_t last_words_in;
+  uint32_t last_words_out;
+  uint32_t total_words_in;
+  uint32_t total_words_out;
+};
+
+// Default memory budget of the conversion cache.
+constexpr uint32_t kDefaultCacheBudget = 32u * 1024u * 1024u;
+
+// Opaque compiler context, see tint_context_create().
+struct TintContext;
+
+// Opaque resolved WGSL shader, see tint_context_shader_create().
+struct TintShader;
+
+// Opaque WGSL document kept in sync with an editor, see
+// tint_context_document_create().
+struct TintDocument;
+
+#if TINT_WASM_THREADS
+// Asynchronous batch started by tint_batch_compile_async().
+struct TintJob;
+
+// Completion callback of an asynchronous batch. In the browser it runs on
+// the main thread, whichever worker finished the batch.
+typedef void (*TintJobCallback)(TintJob *job, void *user_data);
+
+// Completion callback of a request started by tint_convert_async(), with
+// the Status it completed with. Runs on the main thread like the above.
+typedef void (*TintRequestCallback)(uint32_t request_id, uint32_t status,
+                                    void *user_data);
+
+// Returned for requests that are still queued or running.
+constexpr uint32_t kTintRequestPending = 0xffffffffu;
+#endif
+
+// Value of TintBatchResult::diagnostics when a conversion produced no
+// diagnostic text.
+constexpr uint32_t kTintNoDiagnostics = 0xffffffffu;
+
+extern "C" {
+
+// Single shader conversions. The returned pointer is owned by the module
+// and stays valid until the next call of the same export. On failure they
+// return nullptr and tint_last_error() tells what went wrong. None of the
+// exports throw.
+const char *SPV_TO_SPVASM(const uint32_t *spirv, size_t size);
+const void *SPVASM_TO_SPV(const char *spv_asm, size_t size);
+const char *SPV_TO_WGSL(uint32_t *spirv, size_t size);
+const char *SPVASM_TO_WGSL(const char *spv_asm, size_t size);
+const uint32_t *WGSL_TO_SPV(const char *wgsl, size_t size);
+const char *WGSL_TO_SPVASM(const char *wgsl, size_t size);
+size_t GetSPIRVSize();
+const TintError *tint_last_error();
+
+// Nothing is initialized when the module is instantiated; the default
+// context, SPIRV-Tools and Tint's tables are set up by the first call that
+// needs them. tint_warmup() does all of that up front by converting a small
+// built-in shader, so call it while the page is idle to take that cost off
+// the first real conversion. It leaves no trace in the caches, statistics
+// or outputs of any context.
+// Returns: Status, kSuccess once everything is warmed up
+uint32_t tint_warmup();
+
+// Converts `count` shaders in a single call.
+// Returns: Pointer to `count` TintBatchResult rows. The rows, the output
+//          buffers they point at, and the diagnostics blob are owned by
+//          the module and stay valid until the next tint_batch_compile().
+const TintBatchResult *tint_batch_compile(const TintBatchInput *inputs,
+                                          uint32_t count);
+
+// Returns: Base pointer of the NUL-separated diagnostics blob of the last
+//          batch. Add TintBatchResult::diagnostics to get a C string.
+const char *tint_batch_diagnostics();
+
+// Converts one shader. `data` is only read during the call and can be
+// released as soon as it returns. WGSL input is copied into Tint's source
+// file and SPIR-V read by Tint into a word vector, so those conversions
+// pay for one copy of the input; SPIR-V disassembly and assembly read it
+// in place. When out->data is set, the output is copied into that buffer.
+// A buffer that is too small fails with kBufferTooSmall and out->size set
+// to the required size. When out->data is nullptr, out->data receives a
+// buffer owned by the caller, which must be released with
+// tint_output_free(). Text outputs are NUL-terminated whenever there is
+// room. out->diagnostics stays valid until the next tint_convert().
+// Returns: Status, also stored in out->status
+uint32_t tint_convert(uint32_t from, uint32_t to, const void *data,
+                      size_t size, TintOutput *out);
+
+// Releases an output handed to the caller by tint_convert().
+void tint_output_free(void *data);
+
+// Creates a compiler context. A context owns its options, its SPIRV-Tools
+// instance and the storage of every output it returns, so conversions on
+// different contexts never overwrite each other and may run concurrently
+// on different threads. A single context must not be used by two threads
+// at once. Pass nullptr for the options used by the exports above.
+// Returns: New context, released with tint_context_destroy()
+TintContext *tint_context_create(const TintContextOptions *options);
+
+// Destroys a context along with every output it still owns.
+void tint_context_destroy(TintContext *ctx);
+
+// Context variants of the exports above. Outputs stay valid until the
+// next call of the same function on the same context.
+uint32_t tint_context_convert(TintContext *ctx, uint32_t from, uint32_t to,
+                              const void *data, size_t size, TintOutput *out);
+void tint_context_output_free(TintContext *ctx, void *data);
+const TintBatchResult *tint_context_batch_compile(TintContext *ctx,
+                                                  const TintBatchInput *inputs,
+                                                  uint32_t count);
+const char *tint_context_batch_diagnostics(TintContext *ctx);
+
+// Parses and resolves a WGSL shader once and keeps it resident on the
+// context, so that it can be specialized for many sets of override values
+// without going through the frontend again. On failure `*shader` is set to
+// nullptr and tint_context_diagnostics() reports why.
+// Returns: Status. The shader is released with tint_shader_destroy(), which
+//          has to happen before its context is destroyed.
+uint32_t tint_context_shader_create(TintContext *ctx, const char *wgsl,
+                                    size_t size, TintShader **shader);
+
+// Same as above, on the context used by the context-less exports.
+uint32_t tint_shader_create(const char *wgsl, size_t size,
+                            TintShader **shader);
+
+// Generates SPIR-V, SPIR-V ASM or WGSL from a shader with `count`
+// overrides set. Overrides left out keep their initializer, and an
+// override without one fails with kGenerateFailed. An override name or
+// id the shader doesn't declare fails with kInvalidInput. The output is
+// reported like tint_context_convert(), and outputs handed to the caller
+// are released with tint_context_output_free() on the shader's context.
+// Returns: Status, also stored in out->status
+uint32_t tint_shader_specialize(TintShader *shader, uint32_t to,
+                                const TintOverride *overrides, uint32_t count,
+                                TintOutput *out);
+
+// Generates a separate module per entry point of a shader in one call.
+// Each one only contains what its entry point uses, and the overrides are
+// set like tint_shader_specialize() does. The parallel flag blocks the
+// calling thread until every worker is done, so don't use it on the
+// browser main thread.
+// Returns: One TintEntryPointResult row per entry point, in source order,
+//          with the number of rows stored in `rows`, or nullptr if an
+//          override name or id is unknown. The rows, their outputs and the
+//          diagnostics blob are owned by the shader and stay valid until
+//          the next tint_shader_split() on it.
+const TintEntryPointResult *tint_shader_split(TintShader *shader, uint32_t to,
+                                              const TintOverride *overrides,
+                                              uint32_t count, uint32_t flags,
+                                              uint32_t *rows);
+
+// Returns: Base pointer of the NUL-separated diagnostics blob of the last
+//          tint_shader_split() on the shader
+const char *tint_shader_split_diagnostics(TintShader *shader);
+
+void tint_shader_destroy(TintShader *shader);
+
+// Keeps a WGSL document open for an editor. Edits replace byte ranges of
+// the text and only relex the declarations around them. A check then
+// parses and resolves only the declarations the edits can have affected:
+// the changed ones, the ones sharing a name with or referring to them, and
+// what those depend on. The diagnostics of all other declarations are
+// kept from earlier checks, moved along with their declarations.
+// Returns: Status. The document is released with tint_document_destroy(),
+//          which has to happen before its context is destroyed.
+uint32_t tint_context_document_create(TintContext *ctx, const char *wgsl,
+                                      size_t size, TintDocument **doc);
+
+// Same as above, on the context used by the context-less exports.
+uint32_t tint_document_create(const char *wgsl, size_t size,
+                              TintDocument **doc);
+
+// Replaces the bytes [begin, end) of the document with `size` bytes of
+// `text`, e.g. one content change of an LSP didChange notification.
+// Returns: Status, kInvalidInput if the range is outside the document
+uint32_t tint_document_edit(TintDocument *doc, uint32_t begin, uint32_t end,
+                            const char *text, size_t size);
+
+// Brings the diagnostics of the document up to date with its text. A
+// document with syntax errors only reports those, like a full parse.
+// Returns: kSuccess, or kParseFailed if the document has errors
+uint32_t tint_document_check(TintDocument *doc);
+
+// Returns: The diagnostics of the last tint_document_check(), in the table
+//          of the document's context that tint_context_diagnostics() uses,
+//          with the number of rows stored in `count`
+const TintDiagnostic *tint_document_diagnostics(TintDocument *doc,
+                                                uint32_t *count);
+
+void tint_document_stats(TintDocument *doc, TintDocumentStats *stats);
+void tint_document_destroy(TintDocument *doc);
+
+// Every conversion above goes through an in-module cache keyed by a
+// 128-bit hash of the input bytes, the format pair and the context
+// options. Repeated conversions are answered from the cache, and the least
+// recently used entries are evicted once the cache outgrows its budget.
+void tint_cache_set_budget(uint32_t bytes);
+void tint_cache_clear();
+void tint_cache_stats(TintCacheStats *stats);
+
+// Opt-in timing of the compile phases (lexing, parsing, resolving, reading
+// and generating each format, SPIRV-Tools) of the conversions run on a
+// context. Profiling is off by default and costs nothing while it is off.
+// Conversions answered by the conversion cache only record the lookup.
+void tint_context_set_profiling(TintContext *ctx, uint32_t flags);
+
+// Clears the phase statistics and trace events of a context.
+void tint_context_profile_reset(TintContext *ctx);
+
+// Returns: Pointer to one TintPhaseStats row per phase, including phases
+//          that never ran, with the number of rows stored in `count`. The
+//          table is owned by the context and updated in place.
+const TintPhaseStats *tint_context_phase_stats(TintContext *ctx,
+                                               uint32_t *count);
+
+// Returns: The trace events recorded since the last reset as Chrome
+//          trace-event JSON, ready for chrome://tracing or Perfetto. Valid
+//          until the next call on the same context.
+const char *tint_context_trace(TintContext *ctx);
+
+// Same as above, on the context used by the context-less exports.
+void tint_set_profiling(uint32_t flags);
+void tint_profile_reset();
+const TintPhaseStats *tint_phase_stats(uint32_t *count);
+const char *tint_trace();
+
+// Copies the memory statistics of the last conversion on the context into
+// `stats`. Tint's allocators only grow until the structure that owns them
+// is destroyed, so each row is the most that structure ever held, and
+// peak_bytes is the footprint of all of them, which are alive at the same
+// time. Structures the writers build internally (clones of the program,
+// the IR of the AST writers) are not visible and not counted. Everything
+// is zero after a conversion answered by the conversion cache.
+void tint_context_memory_stats(TintContext *ctx, TintMemoryStats *stats);
+
+// Same as above, for the last context-less conversion.
+void tint_memory_stats(TintMemoryStats *stats);
+
+// Structured diagnostics. Every conversion keeps the diagnostics Tint and
+// SPIRV-Tools reported as records, and only flattens their messages to
+// text when they are read through the functions below.
+
+// Returns: One TintDiagnostic per message of the last tint_context_convert()
+//          or single shader export on the context, with the number of rows
+//          stored in `count`. Valid until the next conversion.
+const TintDiagnostic *tint_context_diagnostics(TintContext *ctx,
+                                               uint32_t *count);
+
+// Same as above, for row `index` of the last batch. Returns nullptr with
+// `count` set to 0 when the index is out of range.
+const TintDiagnostic *tint_context_batch_diagnostic_records(TintContext *ctx,
+                                                            uint32_t index,
+                                                            uint32_t *count);
+
+// Returns: The records of tint_context_diagnostics() as a JSON array of
+//          {severity, file, line, column, length, message} objects
+const char *tint_context_diagnostics_json(TintContext *ctx);
+
+// Turns the formatted diagnostics text (tint_last_error(), TintOutput and
+// the batch diagnostics blob) on or off. It is on by default. The text is
+// formatted from the records above, one "file:line:column severity:
+// message" line each, when it is handed out. With it off the text fields
+// stay empty and the records are the only diagnostics reported.
+void tint_context_set_diagnostic_text(TintContext *ctx, uint32_t enabled);
+
+// Same as above, on the context used by the context-less exports.
+const TintDiagnostic *tint_diagnostics(uint32_t *count);
+const TintDiagnostic *tint_batch_diagnostic_records(uint32_t index,
+                                                    uint32_t *count);
+const char *tint_diagnostics_json();
+void tint_set_diagnostic_text(uint32_t enabled);
+
+// Reflection. With it enabled, every conversion that resolves a WGSL or
+// SPIR-V program through the AST (any WGSL input, and SPIR-V to WGSL
+// unless the context uses the IR pipeline) also reflects that program,
+// so there is no need to parse the output again with the inspector.
+// tint_context_shader_create() reflects the shader it creates.
+void tint_context_set_reflection(TintContext *ctx, uint32_t enabled);
+
+// Returns: The reflection of the last tint_context_convert() or single
+//          shader export on the context, or nullptr if it didn't reflect a
+//          program. Valid until the next conversion on the context.
+const TintReflection *tint_context_reflection(TintContext *ctx);
+
+// Same as above, for row `index` of the last batch.
+const TintReflection *tint_context_batch_reflection(TintContext *ctx,
+                                                    uint32_t index);
+
+// Same as above, on the context used by the context-less exports.
+void tint_set_reflection(uint32_t enabled);
+const TintReflection *tint_reflection();
+const TintReflection *tint_batch_reflection(uint32_t index);
+
+// Optimizes every SPIR-V module Tint generates on the context (WGSL to
+// SPIR-V or SPIR-V ASM, shader specializations and splits) with
+// SPIRV-Tools. `mode` is an OptimizeMode. `flags` is only read for
+// OptimizeMode::kCustom, as a whitespace separated list of spirv-opt flags
+// such as "--eliminate-dead-code-aggressive --merge-blocks". The optimizer
+// and its pass list are built once here and reused by every conversion.
+// The optimizer is part of the conversion cache key. Bindings are always
+// preserved.
+// Returns: kSuccess, or kInvalidInput if the mode or a flag is unknown, in
+//          which case the optimizer is turned off
+uint32_t tint_context_set_optimizer(TintContext *ctx, uint32_t mode,
+                                    const char *flags);
+
+// Copies the word counts of the optimizer runs on the context. Conversions
+// answered by the conversion cache don't run the optimizer.
+void tint_context_optimizer_stats(TintContext *ctx, TintOptimizerStats *stats);
+
+// Same as above, on the context used by the context-less exports.
+uint32_t tint_set_optimizer(uint32_t mode, const char *flags);
+void tint_optimizer_stats(TintOptimizerStats *stats);
+
+#if TINT_WASM_THREADS
+// Only available in the threaded build (make threads).
+
+// Spreads a batch over the internal worker pool and returns immediately.
+// The workers convert with the settings the default context has at the
+// time of the call (optimizer, reflection, diagnostic text). Completion is
+// reported through `callback` (may be nullptr) and can also be polled with
+// tint_job_done(). An empty batch is done straight away, and its callback
+// still runs. The shader data referenced by `inputs` must stay alive
+// until the job is done; the table itself is copied.
+TintJob *tint_batch_compile_async(const TintBatchInput *inputs,
+                                  uint32_t count, TintJobCallback callback,
+                                  void *user_data);
+
+// Returns: 1 once the job is done, otherwise 0
+uint32_t tint_job_done(TintJob *job);
+
+// Blocks until the job is done. Not allowed on the browser main thread.
+void tint_job_wait(TintJob *job);
+
+// Same tables as tint_batch_compile() and tint_batch_diagnostics(),
+// owned by the job. Both return nullptr until the job is done.
+const TintBatchResult *tint_job_results(TintJob *job);
+const char *tint_job_diagnostics(TintJob *job);
+
+// Releases a finished job and everything it owns. Unfinished jobs are
+// left alone. Releasing a job whose callback hasn't run yet, or from
+// within the callback, is fine: the job is freed once the callback is
+// done, and a callback that hadn't started by then is skipped.
+void tint_job_release(TintJob *job);
+
+// Queues a single conversion on the worker pool and returns immediately.
+// `request_id` is picked by the caller and identifies the request until
+// tint_request_result() finishes it. The input is copied, so `data` may
+// be released as soon as this returns. Like tint_batch_compile_async(),
+// the request is converted with the settings the default context has at
+// the time of the call. Completion is reported through `callback` (may be
+// nullptr) and can also be polled.
+// Returns: kSuccess once queued, kInvalidInput if `data` is null or the id
+//          is still in use
+uint32_t tint_convert_async(uint32_t request_id, uint32_t from, uint32_t to,
+                            const void *data, size_t size,
+                            TintRequestCallback callback, void *user_data);
+
+// Returns: kTintRequestPending while the request is queued or running, its
+//          Status once it completed, or kInvalidInput for an unknown id
+uint32_t tint_request_status(uint32_t request_id);
+
+// Cancels a request. A queued request never starts, a running one stops
+// before the next stage of its conversion. It then completes with
+// kCancelled and its callback still runs.
+// Returns: 1 if the request is going to complete as kCancelled, 0 if it
+//          completed already or the id is unknown
+uint32_t tint_request_cancel(uint32_t request_id);
+
+// Finishes a completed request: its output is handed over like
+// tint_convert() does, and its id becomes free. Every request has to be
+// finished this way, cancelled ones included. It leaves the records of
+// tint_diagnostics() and tint_reflection() alone, and out->diagnostics
+// stays valid until the next tint_request_result().
+// Returns: kTintRequestPending while the request runs (nothing happens),
+//          otherwise its Status, also stored in out->status
+uint32_t tint_request_result(uint32_t request_id, TintOutput *out);
+#endif
+
+} // extern "C"
+
+#endif // TINT_WASM_H_
@@ -79,6 +79,9 @@ class UniqueAllocator {
     /// @param o the immutable UniqueAlllocator to extend
     void Wrap(const UniqueAllocator<T, HASH, EQUAL>& o) { items = o.items; }
 
+    /// @returns the heap memory held by the allocated objects
+    AllocatorStats Stats() const { return allocator.Stats(); }
+
     /// @returns an iterator to the beginning of the types
     Iterator begin() const { return allocator.Objects().begin(); }
     /// @returns an iterator to the end of the types
@@ -0,0 +1,169 @@
+// Copyright 2024 The Dawn & Tint Authors
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SRC_TINT_UTILS_DIAGNOSTIC_LINE_INDEX_H_
+#define SRC_TINT_UTILS_DIAGNOSTIC_LINE_INDEX_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "utils/diagnostic/source.h"
+#include "utils/text/scan.h"
+
+namespace tint {
+
+/// LineIndex maps between byte offsets into a text and 1-based lines and columns, the way
+/// Source::FileContent splits a file into lines. Unlike FileContent, it doesn't copy the text, and
+/// it only finds the line breaks the first time a line or column is asked for, so text that never
+/// needs a diagnostic or a position lookup is never split. The line breaks are found with
+/// FindLineBreakLead(), 16 bytes at a time with -msimd128.
+///
+/// The index is built by the first query, so a LineIndex must not be queried from several threads
+/// at once until IsBuilt() is true.
+/// @see https://www.w3.org/TR/WGSL/#line-break
+class LineIndex {
+  public:
+    /// Constructor
+    /// @param text the text, which must outlive the index and be smaller than 4 GiB
+    explicit LineIndex(std::string_view text) : text_(text) {}
+
+    /// @returns the text
+    std::string_view Text() const { return text_; }
+
+    /// @returns true once the line breaks have been found
+    bool IsBuilt() const { return !line_starts_.empty(); }
+
+    /// @returns the number of lines. Text that ends with a line break has an empty last line.
+    size_t LineCount() const { return LineStarts().size(); }
+
+    /// @param line the 1-based line number, at most LineCount()
+    /// @returns the byte offset of the start of @p line
+    size_t LineStart(uint32_t line) const { return LineStarts()[line - 1]; }
+
+    /// @param line the 1-based line number, at most LineCount()
+    /// @returns the text of @p line, without its line break
+    std::string_view Line(uint32_t line) const {
+        const auto& starts = LineStarts();
+        size_t start = starts[line - 1];
+        if (line == starts.size()) {
+            return text_.substr(start);
+        }
+        size_t end = starts[line];
+        return text_.substr(start, end - start - LineBreakLengthBefore(end));
+    }
+
+    /// @param offset the byte offset, at most the size of the text
+    /// @returns the line and column of @p offset. Columns count bytes, as in Source::Location.
+    Source::Location Locate(size_t offset) const {
+        const auto& starts = LineStarts();
+        auto it = std::upper_bound(starts.begin(), starts.end(), offset);
+        auto line = static_cast<uint32_t>(it - starts.begin());
+        return Source::Location{line, static_cast<uint32_t>(offset - starts[line - 1] + 1)};
+    }
+
+    /// @param location the line and column
+    /// @returns the byte offset of @p location, or the size of the text if @p location is past the
+    /// last line
+    size_t Offset(const Source::Location& location) const {
+        const auto& starts = LineStarts();
+        if (location.line == 0 || location.line > starts.size()) {
+            return text_.size();
+        }
+        size_t offset = starts[location.line - 1] + (location.column > 0 ? location.column - 1 : 0);
+        return std::min(offset, text_.size());
+    }
+
+  private:
+    /// @returns the offsets of the line starts, finding them first if needed
+    const std::vector<uint32_t>& LineStarts() const {
+        if (line_starts_.empty()) {
+            Build();
+        }
+        return line_starts_;
+    }
+
+    /// @returns the length of the line break that ends right before @p offset
+    size_t LineBreakLengthBefore(size_t offset) const {
+        std::string_view before = text_.substr(0, offset);
+        if (before.size() >= 2 && before.substr(before.size() - 2) == "\r\n") {
+            return 2;
+        }
+        if (before.size() >= 2 && before.substr(before.size() - 2) == "\xc2\x85") {
+            return 2;
+        }
+        if (before.size() >= 3 && (before.substr(before.size() - 3) == "\xe2\x80\xa8" ||
+                                   before.substr(before.size() - 3) == "\xe2\x80\xa9")) {
+            return 3;
+        }
+        return 1;
+    }
+
+    /// Finds the start of every line
+    void Build() const {
+        line_starts_.push_back(0);
+        size_t offset = 0;
+        while ((offset = FindLineBreakLead(text_, offset)) < text_.size()) {
+            size_t length = 0;
+            switch (static_cast<uint8_t>(text_[offset])) {
+                case '\r':
+                    length = text_.substr(offset, 2) == "\r\n" ? 2 : 1;
+                    break;
+                case 0xc2:  // U+0085 next line
+                    length = text_.substr(offset, 2) == "\xc2\x85" ? 2 : 0;
+                    break;
+                case 0xe2:  // U+2028 line separator and U+2029 paragraph separator
+                    length = text_.substr(offset, 3) == "\xe2\x80\xa8" ||
+                                     text_.substr(offset, 3) == "\xe2\x80\xa9"
+                                 ? 3
+                                 : 0;
+                    break;
+                default:  // '\n', '\v' and '\f'
+                    length = 1;
+                    break;
+            }
+            if (length == 0) {
+                // Lead byte of some other character
+                offset++;
+                continue;
+            }
+            offset += length;
+            line_starts_.push_back(static_cast<uint32_t>(offset));
+        }
+    }
+
+    /// The text
+    std::string_view text_;
+    /// The offset of the start of each line, empty until the first query
+    mutable std::vector<uint32_t> line_starts_;
+};
+
+}  // namespace tint
+
+#endif  // SRC_TINT_UTILS_DIAGNOSTIC_LINE_INDEX_H_
@@ -31,6 +31,10 @@
 #include <stdint.h>
 #include <cstddef>
 
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#endif
+
 namespace tint {
 
 /// CRC32 immutable lookup table data.
@@ -81,16 +85,75 @@ constexpr uint32_t CRC32(const char* s) {
     return crc ^ 0xffffffff;
 }
 
+/// @param ptr a pointer to the start of the data
+/// @param size the number of bytes of the data
+/// @returns the CRC32 of the data at @p ptr of size @p size, one byte at a time.
+inline uint32_t CRC32Scalar(const void* ptr, size_t size) {
+    auto* p = static_cast<const uint8_t*>(ptr);
+    uint32_t crc = 0xffffffff;
+    while (size--) {
+        crc = (crc >> 8) ^ kCRC32LUT[static_cast<uint8_t>(crc) ^ *p++];
+    }
+    return crc ^ 0xffffffff;
+}
+
+#ifdef __wasm_simd128__
+
+/// CRC32 lookup tables for slicing by 16 bytes. Entry `i` of table `k` is the CRC32 contribution
+/// of byte `i` followed by `k` zero bytes, so table 0 is kCRC32LUT.
+struct CRC32Slices {
+    /// The lookup tables
+    uint32_t tables[16][256] = {};
+
+    /// Constructor
+    constexpr CRC32Slices() {
+        for (uint32_t i = 0; i < 256; i++) {
+            tables[0][i] = kCRC32LUT[i];
+        }
+        for (uint32_t k = 1; k < 16; k++) {
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t prev = tables[k - 1][i];
+                tables[k][i] = (prev >> 8) ^ kCRC32LUT[prev & 0xff];
+            }
+        }
+    }
+};
+
+/// The CRC32 slicing tables
+inline constexpr CRC32Slices kCRC32Slices{};
+
+#endif  // __wasm_simd128__
+
 /// @param ptr a pointer to the start of the data
 /// @param size the number of bytes of the data
 /// @returns the CRC32 of the data at @p ptr of size @p size.
+/// @note WASM SIMD has no carry-less multiply, so with -msimd128 this loads 16 bytes at a time into
+/// a vector, folds the running CRC into it, and looks up all 16 bytes in the slicing tables
+/// independently instead of in a chain of 16 dependent lookups.
 inline uint32_t CRC32(const void* ptr, size_t size) {
+#ifdef __wasm_simd128__
     auto* p = static_cast<const uint8_t*>(ptr);
     uint32_t crc = 0xffffffff;
+    const auto& t = kCRC32Slices.tables;
+    for (; size >= 16; size -= 16, p += 16) {
+        v128_t seed = wasm_i32x4_make(static_cast<int32_t>(crc), 0, 0, 0);
+        v128_t block = wasm_v128_xor(wasm_v128_load(p), seed);
+        crc = t[15][wasm_u8x16_extract_lane(block, 0)] ^ t[14][wasm_u8x16_extract_lane(block, 1)] ^
+              t[13][wasm_u8x16_extract_lane(block, 2)] ^ t[12][wasm_u8x16_extract_lane(block, 3)] ^
+              t[11][wasm_u8x16_extract_lane(block, 4)] ^ t[10][wasm_u8x16_extract_lane(block, 5)] ^
+              t[9][wasm_u8x16_extract_lane(block, 6)] ^ t[8][wasm_u8x16_extract_lane(block, 7)] ^
+              t[7][wasm_u8x16_extract_lane(block, 8)] ^ t[6][wasm_u8x16_extract_lane(block, 9)] ^
+              t[5][wasm_u8x16_extract_lane(block, 10)] ^ t[4][wasm_u8x16_extract_lane(block, 11)] ^
+              t[3][wasm_u8x16_extract_lane(block, 12)] ^ t[2][wasm_u8x16_extract_lane(block, 13)] ^
+              t[1][wasm_u8x16_extract_lane(block, 14)] ^ t[0][wasm_u8x16_extract_lane(block, 15)];
+    }
     while (size--) {
         crc = (crc >> 8) ^ kCRC32LUT[static_cast<uint8_t>(crc) ^ *p++];
     }
     return crc ^ 0xffffffff;
+#else
+    return CRC32Scalar(ptr, size);
+#endif
 }
 
 }  // namespace tint
@@ -30,6 +30,7 @@
 
 #include <stdint.h>
 #include <cstdio>
+#include <cstring>
 #include <functional>
 #include <string>
 #include <tuple>
@@ -39,6 +40,10 @@
 
 #include "utils/math/crc32.h"
 
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#endif
+
 namespace tint {
 
 namespace detail {
@@ -148,6 +153,85 @@ struct Hasher<std::variant<TYPES...>> {
     }
 };
 
+namespace detail {
+
+/// The initial values of the four lanes of HashBytes()
+constexpr uint32_t kHashBytesSeeds[4] = {0x9e3779b9, 0x85ebca6b, 0xc2b2ae35, 0x27d4eb2f};
+
+/// The multiplier applied to each lane of HashBytes() per block
+constexpr uint32_t kHashBytesPrime = 0x9e3779b1;
+
+/// Combines the lanes of HashBytes() with the bytes after the last full block.
+/// @param lanes the four lanes after the last full block
+/// @param tail the bytes after the last full block
+/// @param tail_size the number of bytes at @p tail, less than 16
+/// @param size the total number of bytes hashed
+/// @returns the hash
+inline HashCode HashBytesFinish(const uint32_t* lanes,
+                                const uint8_t* tail,
+                                size_t tail_size,
+                                size_t size) {
+    uint32_t hash = static_cast<uint32_t>(size);
+    for (size_t i = 0; i < 4; i++) {
+        hash = (hash ^ lanes[i]) * 0x85ebca6b;
+        hash ^= hash >> 13;
+    }
+    for (size_t i = 0; i < tail_size; i++) {
+        hash = (hash ^ tail[i]) * 0x01000193;
+    }
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6b;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+}  // namespace detail
+
+/// @param ptr a pointer to the start of the data
+/// @param size the number of bytes of the data
+/// @returns a hash of the data at @p ptr of size @p size. The data is consumed in blocks of 16
+/// bytes, each of which updates four independent 32-bit lanes, so that HashBytes() can hash a block
+/// with a single SIMD128 multiply. Both give the same result.
+inline HashCode HashBytesScalar(const void* ptr, size_t size) {
+    auto* p = static_cast<const uint8_t*>(ptr);
+    uint32_t lanes[4] = {detail::kHashBytesSeeds[0], detail::kHashBytesSeeds[1],
+                         detail::kHashBytesSeeds[2], detail::kHashBytesSeeds[3]};
+    size_t blocks = size / 16;
+    for (size_t b = 0; b < blocks; b++, p += 16) {
+        for (size_t i = 0; i < 4; i++) {
+            uint32_t k;
+            memcpy(&k, p + i * 4, sizeof(k));
+            lanes[i] = (lanes[i] ^ k) * detail::kHashBytesPrime;
+            lanes[i] ^= lanes[i] >> 15;
+        }
+    }
+    return detail::HashBytesFinish(lanes, p, size % 16, size);
+}
+
+/// HashBytesScalar(), with one SIMD128 multiply per 16 byte block with -msimd128
+/// @param ptr a pointer to the start of the data
+/// @param size the number of bytes of the data
+/// @returns a hash of the data at @p ptr of size @p size
+inline HashCode HashBytes(const void* ptr, size_t size) {
+#ifdef __wasm_simd128__
+    auto* p = static_cast<const uint8_t*>(ptr);
+    v128_t lanes = wasm_v128_load(detail::kHashBytesSeeds);
+    const v128_t prime = wasm_i32x4_splat(static_cast<int32_t>(detail::kHashBytesPrime));
+    size_t blocks = size / 16;
+    for (size_t b = 0; b < blocks; b++, p += 16) {
+        lanes = wasm_i32x4_mul(wasm_v128_xor(lanes, wasm_v128_load(p)), prime);
+        lanes = wasm_v128_xor(lanes, wasm_u32x4_shr(lanes, 15));
+    }
+    uint32_t result[4];
+    wasm_v128_store(result, lanes);
+    return detail::HashBytesFinish(result, p, size % 16, size);
+#else
+    return HashBytesScalar(ptr, size);
+#endif
+}
+
 /// Hasher specialization for std::string, which also supports hashing of const char* and
 /// std::string_view without first constructing a std::string.
 template <>
@@ -33,6 +33,7 @@
 #include <utility>
 
 #include "utils/math/math.h"
+#include "utils/memory/allocator_stats.h"
 #include "utils/memory/bitcast.h"
 
 namespace tint {
@@ -227,6 +228,17 @@ class BlockAllocator {
     /// @returns the total number of allocated objects.
     size_t Count() const { return data.count; }
 
+    /// @returns the number of objects, and the number of blocks and bytes allocated from the heap
+    AllocatorStats Stats() const {
+        AllocatorStats stats;
+        stats.objects = data.count;
+        for (auto* block = data.block.root; block != nullptr; block = block->next) {
+            stats.blocks++;
+        }
+        stats.bytes = stats.blocks * sizeof(Block);
+        return stats;
+    }
+
   private:
     BlockAllocator(const BlockAllocator&) = delete;
     BlockAllocator& operator=(const BlockAllocator&) = delete;
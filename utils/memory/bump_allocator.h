@@ -36,6 +36,7 @@
 
 #include "utils/macros/compiler.h"
 #include "utils/math/math.h"
+#include "utils/memory/allocator_stats.h"
 #include "utils/memory/bitcast.h"
 
 namespace tint {
@@ -123,6 +124,22 @@ class BumpAllocator {
     /// @returns the total number of allocations
     size_t Count() const { return data.count; }
 
+    /// @returns the number of allocations, and the number of blocks and bytes allocated from the
+    /// heap
+    /// @note only the size of the current block is recorded, so earlier blocks are assumed to be
+    /// kDefaultBlockDataSize. This only undercounts blocks made for single allocations larger than
+    /// that.
+    AllocatorStats Stats() const {
+        AllocatorStats stats;
+        stats.objects = data.count;
+        for (auto* block = data.root; block != nullptr; block = block->next) {
+            stats.blocks++;
+            stats.bytes += sizeof(BlockHeader) + (block == data.current ? data.current_data_size
+                                                                        : kDefaultBlockDataSize);
+        }
+        return stats;
+    }
+
   private:
     BumpAllocator(const BumpAllocator&) = delete;
     BumpAllocator& operator=(const BumpAllocator&) = delete;
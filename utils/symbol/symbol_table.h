@@ -99,6 +99,9 @@ class SymbolTable {
     /// @returns the identifier of the Program that owns this symbol table.
     tint::GenerationID GenerationID() const { return generation_id_; }
 
+    /// @returns the heap memory held by the symbol names
+    AllocatorStats Stats() const { return name_allocator_.Stats(); }
+
   private:
     SymbolTable(const SymbolTable&) = delete;
     SymbolTable& operator=(const SymbolTable& other) = delete;
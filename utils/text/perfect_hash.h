@@ -0,0 +1,233 @@
+// Copyright 2024 The Dawn & Tint Authors
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SRC_TINT_UTILS_TEXT_PERFECT_HASH_H_
+#define SRC_TINT_UTILS_TEXT_PERFECT_HASH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace tint {
+
+namespace detail {
+
+/// Called by the PerfectHash constructor when it finds no displacement for a bucket. It isn't
+/// constexpr, so building a PerfectHash of such a key set in a constant expression fails to
+/// compile. This only happens if two keys are equal.
+inline void PerfectHashHasDuplicateKeys() {}
+
+}  // namespace detail
+
+/// PerfectHash maps a fixed set of N strings to their indices, with a hash table built at compile
+/// time that has no collisions. A lookup hashes the string once, reads one displacement and one
+/// slot, and finishes with a single string comparison against the only key it can be.
+///
+/// The table uses hash and displace: every key falls in a bucket by the high bits of its hash, and
+/// each bucket stores the displacement that sends all of its keys to free slots. Buckets are placed
+/// largest first, into a slot array at most half full.
+/// @tparam N the number of keys
+template <size_t N>
+class PerfectHash {
+  public:
+    static_assert(N > 0 && N < 0xffff, "PerfectHash supports 1 to 65534 keys");
+
+    /// The number of slots, a power of two with at least two slots per key
+    static constexpr size_t kSlots = [] {
+        size_t slots = 1;
+        while (slots < 2 * N) {
+            slots *= 2;
+        }
+        return slots;
+    }();
+
+    /// The number of buckets, a power of two with about two keys per bucket
+    static constexpr size_t kBuckets = [] {
+        size_t buckets = 1;
+        while (buckets * 2 < N) {
+            buckets *= 2;
+        }
+        return buckets;
+    }();
+
+    /// Constructor
+    /// @param keys the keys, which must be unique and not empty. Each key must convert to a
+    /// std::string_view, and the memory it points to must outlive this PerfectHash.
+    template <typename T>
+    constexpr explicit PerfectHash(const T (&keys)[N]) {
+        uint64_t hashes[N] = {};
+        // The keys sorted by bucket. The keys of bucket `b` are members[starts[b]..starts[b+1]).
+        size_t starts[kBuckets + 1] = {};
+        size_t members[N] = {};
+        for (size_t i = 0; i < N; i++) {
+            keys_[i] = std::string_view(keys[i]);
+            hashes[i] = Hash(keys_[i]);
+            starts[Bucket(hashes[i]) + 1]++;
+            min_length_ = i == 0 || keys_[i].size() < min_length_ ? keys_[i].size() : min_length_;
+            max_length_ = keys_[i].size() > max_length_ ? keys_[i].size() : max_length_;
+        }
+        size_t largest = 0;
+        for (size_t bucket = 0; bucket < kBuckets; bucket++) {
+            largest = starts[bucket + 1] > largest ? starts[bucket + 1] : largest;
+            starts[bucket + 1] += starts[bucket];
+        }
+        size_t ends[kBuckets] = {};
+        for (size_t bucket = 0; bucket < kBuckets; bucket++) {
+            ends[bucket] = starts[bucket];
+        }
+        for (size_t i = 0; i < N; i++) {
+            members[ends[Bucket(hashes[i])]++] = i;
+        }
+        for (auto& slot : slots_) {
+            slot = kEmpty;
+        }
+        for (size_t size = largest; size > 0; size--) {
+            for (size_t bucket = 0; bucket < kBuckets; bucket++) {
+                if (starts[bucket + 1] - starts[bucket] == size) {
+                    Place(bucket, hashes, members + starts[bucket], size);
+                }
+            }
+        }
+    }
+
+    /// @param str the string to look up
+    /// @returns the index of the key equal to @p str, or std::nullopt if there is none
+    constexpr std::optional<size_t> Find(std::string_view str) const {
+        if (str.size() < min_length_ || str.size() > max_length_) {
+            return std::nullopt;
+        }
+        uint64_t hash = Hash(str);
+        size_t index = slots_[Slot(hash, displacements_[Bucket(hash)])];
+        // An empty slot holds kEmpty, and keys_[kEmpty] is the empty string, which `str` can't be
+        if (keys_[index] != str) {
+            return std::nullopt;
+        }
+        return index;
+    }
+
+    /// @returns the length of the shortest key
+    constexpr size_t MinLength() const { return min_length_; }
+
+    /// @returns the length of the longest key
+    constexpr size_t MaxLength() const { return max_length_; }
+
+  private:
+    /// The slot value of an empty slot
+    static constexpr uint16_t kEmpty = static_cast<uint16_t>(N);
+
+    /// @returns @p value with its bits mixed, with the MurmurHash3 64-bit finalizer
+    static constexpr uint64_t Mix(uint64_t value) {
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccdull;
+        value ^= value >> 33;
+        value *= 0xc4ceb9fe1a85ec53ull;
+        value ^= value >> 33;
+        return value;
+    }
+
+    /// @returns @p count bytes of @p str from @p offset, as a little-endian word
+    static constexpr uint64_t Load(std::string_view str, size_t offset, size_t count) {
+        uint64_t word = 0;
+        for (size_t i = 0; i < count; i++) {
+            word |= static_cast<uint64_t>(static_cast<uint8_t>(str[offset + i])) << (8 * i);
+        }
+        return word;
+    }
+
+    /// @returns the hash of @p str, which takes it 8 bytes at a time
+    static constexpr uint64_t Hash(std::string_view str) {
+        uint64_t hash = 0x9e3779b97f4a7c15ull ^ str.size();
+        size_t offset = 0;
+        for (; offset + 8 <= str.size(); offset += 8) {
+            hash = (hash ^ Load(str, offset, 8)) * 0x100000001b3ull;
+            hash ^= hash >> 29;
+        }
+        if (offset < str.size()) {
+            hash = (hash ^ Load(str, offset, str.size() - offset)) * 0x100000001b3ull;
+        }
+        return Mix(hash);
+    }
+
+    /// @returns the bucket of the key with hash @p hash
+    static constexpr size_t Bucket(uint64_t hash) {
+        return static_cast<size_t>(hash >> 40) & (kBuckets - 1);
+    }
+
+    /// @returns the slot of the key with hash @p hash, in a bucket with displacement
+    /// @p displacement
+    static constexpr size_t Slot(uint64_t hash, uint16_t displacement) {
+        return static_cast<size_t>(Mix(hash + displacement)) & (kSlots - 1);
+    }
+
+    /// Finds a displacement that sends every key of bucket @p bucket to a free slot, and fills
+    /// those slots.
+    /// @param bucket the bucket
+    /// @param hashes the hashes of all keys
+    /// @param members the indices of the keys in @p bucket
+    /// @param count the number of keys in @p bucket
+    constexpr void Place(size_t bucket,
+                         const uint64_t (&hashes)[N],
+                         const size_t* members,
+                         size_t count) {
+        for (uint32_t displacement = 0; displacement <= 0xffff; displacement++) {
+            auto d = static_cast<uint16_t>(displacement);
+            size_t placed = 0;
+            for (; placed < count; placed++) {
+                size_t slot = Slot(hashes[members[placed]], d);
+                if (slots_[slot] != kEmpty) {
+                    break;
+                }
+                slots_[slot] = static_cast<uint16_t>(members[placed]);
+            }
+            if (placed == count) {
+                displacements_[bucket] = d;
+                return;
+            }
+            // Collision, take back the slots of this attempt
+            for (size_t i = 0; i < placed; i++) {
+                slots_[Slot(hashes[members[i]], d)] = kEmpty;
+            }
+        }
+        detail::PerfectHashHasDuplicateKeys();
+    }
+
+    /// The keys, followed by an empty string for empty slots
+    std::string_view keys_[N + 1] = {};
+    /// The key index of each slot, or kEmpty
+    uint16_t slots_[kSlots] = {};
+    /// The displacement of each bucket
+    uint16_t displacements_[kBuckets] = {};
+    /// The length of the shortest key
+    size_t min_length_ = 0;
+    /// The length of the longest key
+    size_t max_length_ = 0;
+};
+
+}  // namespace tint
+
+#endif  // SRC_TINT_UTILS_TEXT_PERFECT_HASH_H_
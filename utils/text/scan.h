@@ -0,0 +1,244 @@
+// Copyright 2024 The Dawn & Tint Authors
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef SRC_TINT_UTILS_TEXT_SCAN_H_
+#define SRC_TINT_UTILS_TEXT_SCAN_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#endif
+
+// Byte scanning kernels for WGSL text. Each kernel only handles ASCII and stops at the first byte
+// it does not accept, which includes every byte of a multi-byte UTF-8 sequence, so a caller falls
+// back to a unicode aware path for anything else. With -msimd128 the kernels test 16 bytes at a
+// time and finish the last few bytes with the scalar version. Tint's lexer does not use them:
+// LineIndex calls FindLineBreakLead(), and the others are only called by the benchmarks.
+
+namespace tint {
+
+namespace detail {
+
+/// @param c the byte to test
+/// @returns true if @p c is ASCII blankspace: space, tab, line feed, vertical tab, form feed or
+/// carriage return
+inline bool IsAsciiBlankspace(uint8_t c) {
+    return c == ' ' || static_cast<uint8_t>(c - '\t') <= '\r' - '\t';
+}
+
+/// @param c the byte to test
+/// @returns true if @p c is an ASCII letter, digit or underscore
+inline bool IsAsciiIdentifier(uint8_t c) {
+    return static_cast<uint8_t>((c | 0x20) - 'a') <= 'z' - 'a' ||
+           static_cast<uint8_t>(c - '0') <= 9 || c == '_';
+}
+
+/// @param c the byte to test
+/// @returns true if @p c can start or end a block comment
+inline bool IsBlockCommentDelimiter(uint8_t c) {
+    return c == '*' || c == '/';
+}
+
+/// @param c the byte to test
+/// @returns true if @p c can start a line break: line feed, vertical tab, form feed, carriage
+/// return, or the lead byte of U+0085, U+2028 or U+2029
+inline bool IsLineBreakLead(uint8_t c) {
+    return static_cast<uint8_t>(c - '\n') <= '\r' - '\n' || c == 0xc2 || c == 0xe2;
+}
+
+#ifdef __wasm_simd128__
+
+/// @param c 16 bytes
+/// @returns a lane mask of the bytes in @p c that are ASCII blankspace
+inline v128_t AsciiBlankspaceMask(v128_t c) {
+    return wasm_v128_or(wasm_i8x16_eq(c, wasm_i8x16_splat(' ')),
+                        wasm_u8x16_le(wasm_i8x16_sub(c, wasm_i8x16_splat('\t')),
+                                      wasm_i8x16_splat('\r' - '\t')));
+}
+
+/// @param c 16 bytes
+/// @returns a lane mask of the bytes in @p c that are ASCII letters, digits or underscores
+inline v128_t AsciiIdentifierMask(v128_t c) {
+    v128_t lower = wasm_v128_or(c, wasm_i8x16_splat(0x20));
+    v128_t alpha = wasm_u8x16_le(wasm_i8x16_sub(lower, wasm_i8x16_splat('a')),
+                                 wasm_i8x16_splat('z' - 'a'));
+    v128_t digit =
+        wasm_u8x16_le(wasm_i8x16_sub(c, wasm_i8x16_splat('0')), wasm_i8x16_splat(9));
+    return wasm_v128_or(wasm_v128_or(alpha, digit), wasm_i8x16_eq(c, wasm_i8x16_splat('_')));
+}
+
+/// @param c 16 bytes
+/// @returns a lane mask of the bytes in @p c that can start or end a block comment
+inline v128_t BlockCommentDelimiterMask(v128_t c) {
+    return wasm_v128_or(wasm_i8x16_eq(c, wasm_i8x16_splat('*')),
+                        wasm_i8x16_eq(c, wasm_i8x16_splat('/')));
+}
+
+/// @param c 16 bytes
+/// @returns a lane mask of the bytes in @p c that can start a line break
+inline v128_t LineBreakLeadMask(v128_t c) {
+    v128_t ascii = wasm_u8x16_le(wasm_i8x16_sub(c, wasm_i8x16_splat('\n')),
+                                 wasm_i8x16_splat('\r' - '\n'));
+    return wasm_v128_or(ascii, wasm_v128_or(wasm_i8x16_eq(c, wasm_u8x16_splat(0xc2)),
+                                            wasm_i8x16_eq(c, wasm_u8x16_splat(0xe2))));
+}
+
+/// Advances @p offset over @p text in blocks of 16 bytes, up to the first byte whose lane in
+/// @p mask is set (if @p want_match is true) or clear (if @p want_match is false).
+/// @param text the text to scan
+/// @param offset the offset to start at. Updated to the stopping byte, or to the start of the
+/// last block of less than 16 bytes if there is no stopping byte before it.
+/// @param mask returns the lane mask of the bytes of a block
+/// @param want_match true to stop at a byte in the mask, false to stop at a byte outside of it
+/// @returns true if a stopping byte was found
+template <typename MASK>
+inline bool ScanBlocks(std::string_view text, size_t& offset, MASK&& mask, bool want_match) {
+    const char* data = text.data();
+    while (offset + 16 <= text.size()) {
+        v128_t block = wasm_v128_load(data + offset);
+        uint32_t bits = static_cast<uint32_t>(wasm_i8x16_bitmask(mask(block)));
+        if (!want_match) {
+            bits = ~bits & 0xffff;
+        }
+        if (bits != 0) {
+            offset += static_cast<size_t>(__builtin_ctz(bits));
+            return true;
+        }
+        offset += 16;
+    }
+    return false;
+}
+
+#endif  // __wasm_simd128__
+
+}  // namespace detail
+
+/// @param text the text to scan
+/// @param offset the offset to start at
+/// @returns the offset of the first byte at or after @p offset that is not ASCII blankspace, or the
+/// size of @p text if there is none
+inline size_t SkipAsciiBlankspaceScalar(std::string_view text, size_t offset) {
+    while (offset < text.size() && detail::IsAsciiBlankspace(static_cast<uint8_t>(text[offset]))) {
+        offset++;
+    }
+    return offset;
+}
+
+/// @param text the text to scan
+/// @param offset the offset to start at
+/// @returns the offset of the first byte at or after @p offset that is not an ASCII letter, digit
+/// or underscore, or the size of @p text if there is none
+inline size_t ScanAsciiIdentifierScalar(std::string_view text, size_t offset) {
+    while (offset < text.size() && detail::IsAsciiIdentifier(static_cast<uint8_t>(text[offset]))) {
+        offset++;
+    }
+    return offset;
+}
+
+/// @param text the text to scan
+/// @param offset the offset to start at
+/// @returns the offset of the first '*' or '/' at or after @p offset, or the size of @p text if
+/// there is none. Everything in between is the body of a block comment.
+inline size_t FindBlockCommentDelimiterScalar(std::string_view text, size_t offset) {
+    while (offset < text.size() &&
+           !detail::IsBlockCommentDelimiter(static_cast<uint8_t>(text[offset]))) {
+        offset++;
+    }
+    return offset;
+}
+
+/// @param text the text to scan
+/// @param offset the offset to start at
+/// @returns the offset of the first byte at or after @p offset that may start a line break, or the
+/// size of @p text if there is none. The caller checks whether a 0xc2 or 0xe2 byte really starts
+/// U+0085, U+2028 or U+2029.
+inline size_t FindLineBreakLeadScalar(std::string_view text, size_t offset) {
+    while (offset < text.size() && !detail::IsLineBreakLead(static_cast<uint8_t>(text[offset]))) {
+        offset++;
+    }
+    return offset;
+}
+
+/// SkipAsciiBlankspaceScalar(), 16 bytes at a time with -msimd128
+/// @param text the text to scan
+/// @param offset the offset to start at
+/// @returns the offset of the first byte at or after @p offset that is not ASCII blankspace
+inline size_t SkipAsciiBlankspace(std::string_view text, size_t offset) {
+#ifdef __wasm_simd128__
+    if (detail::ScanBlocks(text, offset, detail::AsciiBlankspaceMask, false)) {
+        return offset;
+    }
+#endif
+    return SkipAsciiBlankspaceScalar(text, offset);
+}
+
+/// ScanAsciiIdentifierScalar(), 16 bytes at a time with -msimd128
+/// @param text the text to scan
+/// @param offset the offset to start at
+/// @returns the offset of the first byte at or after @p offset that is not an ASCII letter, digit
+/// or underscore
+inline size_t ScanAsciiIdentifier(std::string_view text, size_t offset) {
+#ifdef __wasm_simd128__
+    if (detail::ScanBlocks(text, offset, detail::AsciiIdentifierMask, false)) {
+        return offset;
+    }
+#endif
+    return ScanAsciiIdentifierScalar(text, offset);
+}
+
+/// FindBlockCommentDelimiterScalar(), 16 bytes at a time with -msimd128
+/// @param text the text to scan
+/// @param offset the offset to start at
+/// @returns the offset of the first '*' or '/' at or after @p offset
+inline size_t FindBlockCommentDelimiter(std::string_view text, size_t offset) {
+#ifdef __wasm_simd128__
+    if (detail::ScanBlocks(text, offset, detail::BlockCommentDelimiterMask, true)) {
+        return offset;
+    }
+#endif
+    return FindBlockCommentDelimiterScalar(text, offset);
+}
+
+/// FindLineBreakLeadScalar(), 16 bytes at a time with -msimd128
+/// @param text the text to scan
+/// @param offset the offset to start at
+/// @returns the offset of the first byte at or after @p offset that may start a line break
+inline size_t FindLineBreakLead(std::string_view text, size_t offset) {
+#ifdef __wasm_simd128__
+    if (detail::ScanBlocks(text, offset, detail::LineBreakLeadMask, true)) {
+        return offset;
+    }
+#endif
+    return FindLineBreakLeadScalar(text, offset);
+}
+
+}  // namespace tint
+
+#endif  // SRC_TINT_UTILS_TEXT_SCAN_H_